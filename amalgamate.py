@@ -0,0 +1,106 @@
+#!/usr/bin/env python3
+# Regenerates common.h, the single-header release of queue/queue.h +
+# broadcast/broadcast.h for services that vendor one file instead of
+# the repo. Besides concatenating, it:
+#   - makes every function "static inline" (the sources use plain
+#     "static", so each TU got its own copy and cross-TU calls never
+#     inlined without LTO),
+#   - force-inlines the four hot entry points (queue_pop, queue_push,
+#     brdct_reader_slice, brdct_writer_slice) via COMMON_INLINE, since
+#     MSVC in particular refuses them at plain "inline",
+#   - wraps the CAS-retry loop conditions in COMMON_UNLIKELY so the
+#     fall-through path is laid out straight.
+# Run from the repo root:  ./amalgamate.py > /dev/null  (writes common.h)
+
+import re
+import sys
+
+SOURCES = ["queue/queue.h", "broadcast/broadcast.h"]
+
+HOT = ["queue_pop", "queue_push", "brdct_reader_slice",
+       "brdct_writer_slice"]
+
+PREAMBLE = """\
+#ifndef COMMON_H
+#define COMMON_H
+
+/* Single-header amalgamation of queue/queue.h and broadcast/broadcast.h.
+ * Generated by amalgamate.py -- edit the sources, not this file. */
+
+#if defined(_MSC_VER)
+#define COMMON_INLINE static __forceinline
+#define COMMON_UNLIKELY(x) (x)
+#else
+#define COMMON_INLINE static inline __attribute__((always_inline))
+#define COMMON_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#endif
+"""
+
+
+def strip_license(text):
+    if text.startswith("/*"):
+        return text[text.index("*/") + 2:].lstrip("\n")
+    return text
+
+
+def strip_guard(text):
+    lines = text.split("\n")
+    out = []
+    guard = None
+    for ln in lines:
+        m = re.match(r"#ifndef (\w+_H)\b", ln)
+        if guard is None and m:
+            guard = m.group(1)
+            continue
+        if guard and ln.strip() == "#define " + guard:
+            guard = "seen"
+            continue
+        out.append(ln)
+    # drop the final #endif that closed the guard
+    for i in range(len(out) - 1, -1, -1):
+        if out[i].startswith("#endif"):
+            del out[i]
+            break
+    return "\n".join(out).strip("\n")
+
+
+def annotate(text):
+    # every plain "static" function definition becomes "static inline"
+    out = []
+    for ln in text.split("\n"):
+        if (ln.startswith("static ")
+                and not ln.startswith("static inline")
+                and "(" in ln and not ln.rstrip().endswith(";")):
+            ln = "static inline " + ln[len("static "):]
+        out.append(ln)
+    text = "\n".join(out)
+    # force-inline the hot entry points
+    for fn in HOT:
+        text = text.replace("static inline " + "Slice " + fn + "(",
+                            "COMMON_INLINE Slice " + fn + "(")
+        text = text.replace("static inline " + "size_t " + fn + "(",
+                            "COMMON_INLINE size_t " + fn + "(")
+    # hint the CAS-retry loops as the cold path
+    text = re.sub(r"\} while \((.*?)\);",
+                  lambda m: "} while (COMMON_UNLIKELY(" + m.group(1) + "));",
+                  text, flags=re.S)
+    return text
+
+
+def main():
+    lic = None
+    parts = []
+    for path in SOURCES:
+        with open(path) as f:
+            text = f.read()
+        if lic is None:
+            lic = text[:text.index("*/") + 2]
+        parts.append(annotate(strip_guard(strip_license(text))))
+    with open("common.h", "w") as f:
+        f.write(lic + "\n\n" + PREAMBLE + "\n"
+                + "\n\n".join(parts) + "\n\n#endif // COMMON_H\n")
+    print("wrote common.h", file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,247 @@
+// Throughput/latency benchmark suite for queue.h and broadcast.h.
+//
+// Emits CSV on stdout, one row per measurement:
+//
+//   benchmark,param,threads,value,unit
+//
+// Covered:
+//   spsc_ops        queue_push/queue_pop ops/sec at batch sizes 1..512
+//   brdct_ops       brdct_writer_slice throughput vs reader count
+//   spsc_latency    p50/p99/p999 inter-thread latency via timestamped
+//                   slots, nanoseconds
+//
+// Build and run:
+//   gcc -O3 -pthread bench.c -o bench && ./bench
+//   make bench && ./bench
+//
+// Options:
+//   -s SECONDS   measurement window per configuration (default 0.5)
+//   -r READERS   max broadcast reader count (default 8)
+//   -c A,B       pin producer to cpu A and consumer to cpu B for the
+//                SPSC benchmarks (same-core vs cross-socket runs)
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <sched.h>
+#include <pthread.h>
+#include "../queue/queue.h"
+#include "../broadcast/broadcast.h"
+
+#define QEXP 12
+
+static double bench_secs = 0.5;
+static int max_readers = 8;
+static int pin_prod = -1, pin_cons = -1;
+
+static uint64_t now_ns(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static void pin_self(int cpu)
+{
+    if (cpu < 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+}
+
+// ---------------------------------------------------------------- spsc_ops
+
+static Queue spsc_q;
+static uint64_t spsc_slots[1 << QEXP];
+static size_t spsc_batch;
+static volatile int spsc_stop;
+
+static void *spsc_ops_producer(void *arg)
+{
+    (void)arg;
+    pin_self(pin_prod);
+    while (!spsc_stop)
+    {
+        size_t count;
+        size_t idx = queue_push(&spsc_q, QEXP, &count);
+        if (count > spsc_batch) count = spsc_batch;
+        for (size_t k = 0; k < count; k++) spsc_slots[idx + k] = k;
+        queue_commit_push(&spsc_q, count);
+    }
+    return 0;
+}
+
+static void bench_spsc_ops(void)
+{
+    for (spsc_batch = 1; spsc_batch <= 512; spsc_batch *= 8)
+    {
+        spsc_q.head = spsc_q.tail = 0;
+        spsc_stop = 0;
+        pthread_t prod;
+        pthread_create(&prod, 0, spsc_ops_producer, 0);
+        pin_self(pin_cons);
+
+        uint64_t ops = 0, start = now_ns();
+        uint64_t deadline = start + (uint64_t)(bench_secs * 1e9);
+        while (now_ns() < deadline)
+        {
+            size_t count;
+            queue_pop(&spsc_q, QEXP, &count);
+            if (count > spsc_batch) count = spsc_batch;
+            queue_commit_pop(&spsc_q, count);
+            ops += count;
+        }
+        double secs = (now_ns() - start) / 1e9;
+        spsc_stop = 1;
+        pthread_join(prod, 0);
+        printf("spsc_ops,batch=%zu,2,%.0f,ops/s\n", spsc_batch, ops / secs);
+    }
+}
+
+// --------------------------------------------------------------- brdct_ops
+
+static Broadcast brd_q;
+static char brd_slots[1 << QEXP];
+static volatile int brd_stop;
+
+static void *brdct_reader(void *arg)
+{
+    (void)arg;
+    Reader r;
+    unsigned long sum = 0;
+    if (brdct_attach_reader(&brd_q, QEXP, &r)) return 0;
+    while (!brd_stop)
+    {
+        Slice s = brdct_reader_slice(&brd_q, QEXP, &r);
+        for (int i = 0; i < 2; i++)
+            for (size_t k = 0; k < s.cnt[i]; k++)
+                sum += (unsigned char)brd_slots[s.idx[i] + k];
+        s.cnt[0] = 0;
+        s.cnt[1] = 0;
+        brdct_reader_commit(&brd_q, QEXP, &r, &s);
+    }
+    brdct_detach_reader(&brd_q, QEXP, &r);
+    return (void *)sum; // keeps the loads from being optimized out
+}
+
+static void bench_brdct_ops(void)
+{
+    for (int nr = 1; nr <= max_readers; nr *= 2)
+    {
+        memset(&brd_q, 0, sizeof(brd_q));
+        brd_stop = 0;
+        pthread_t thr[64];
+        for (int i = 0; i < nr; i++)
+            pthread_create(&thr[i], 0, brdct_reader, 0);
+
+        uint64_t ops = 0, start = now_ns();
+        uint64_t deadline = start + (uint64_t)(bench_secs * 1e9);
+        while (now_ns() < deadline)
+        {
+            Slice s = brdct_writer_slice(&brd_q, QEXP);
+            // touch the data like the SPSC benchmark does, so the two
+            // measure comparable per-element work
+            for (int i = 0; i < 2; i++)
+                for (size_t k = 0; k < s.cnt[i]; k++)
+                    brd_slots[s.idx[i] + k] = (char)k;
+            ops += s.len;
+            s.cnt[0] = 0;
+            s.cnt[1] = 0;
+            brdct_writer_commit(&brd_q, QEXP, &s);
+        }
+        double secs = (now_ns() - start) / 1e9;
+        brd_stop = 1;
+        for (int i = 0; i < nr; i++) pthread_join(thr[i], 0);
+        printf("brdct_ops,readers=%d,%d,%.0f,elems/s\n", nr, nr + 1,
+            ops / secs);
+    }
+}
+
+// ------------------------------------------------------------ spsc_latency
+
+#define LAT_SAMPLES 100000
+
+static uint64_t *lat_samples;
+static size_t lat_count;
+
+static void *spsc_lat_producer(void *arg)
+{
+    (void)arg;
+    pin_self(pin_prod);
+    while (!spsc_stop)
+    {
+        size_t count;
+        size_t idx = queue_push(&spsc_q, QEXP, &count);
+        if (!count) continue;
+        spsc_slots[idx] = now_ns();
+        queue_commit_push(&spsc_q, 1);
+    }
+    return 0;
+}
+
+static int cmp_u64(const void *a, const void *b)
+{
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return x < y ? -1 : x > y;
+}
+
+static void bench_spsc_latency(void)
+{
+    spsc_q.head = spsc_q.tail = 0;
+    spsc_stop = 0;
+    lat_count = 0;
+    pthread_t prod;
+    pthread_create(&prod, 0, spsc_lat_producer, 0);
+    pin_self(pin_cons);
+
+    while (lat_count < LAT_SAMPLES)
+    {
+        size_t count;
+        size_t idx = queue_pop(&spsc_q, QEXP, &count);
+        if (!count) continue;
+        for (size_t k = 0; k < count && lat_count < LAT_SAMPLES; k++)
+        {
+            uint64_t t = now_ns();
+            if (t > spsc_slots[idx + k])
+                lat_samples[lat_count++] = t - spsc_slots[idx + k];
+        }
+        queue_commit_pop(&spsc_q, count);
+    }
+    spsc_stop = 1;
+    pthread_join(prod, 0);
+
+    qsort(lat_samples, lat_count, sizeof(*lat_samples), cmp_u64);
+    printf("spsc_latency,p50,2,%llu,ns\n",
+        (unsigned long long)lat_samples[lat_count / 2]);
+    printf("spsc_latency,p99,2,%llu,ns\n",
+        (unsigned long long)lat_samples[lat_count * 99 / 100]);
+    printf("spsc_latency,p999,2,%llu,ns\n",
+        (unsigned long long)lat_samples[lat_count * 999 / 1000]);
+}
+
+int main(int argc, char **argv)
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-s") && i + 1 < argc)
+            bench_secs = atof(argv[++i]);
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc)
+            max_readers = atoi(argv[++i]);
+        else if (!strcmp(argv[i], "-c") && i + 1 < argc)
+            sscanf(argv[++i], "%d,%d", &pin_prod, &pin_cons);
+    }
+    if (max_readers > 64) max_readers = 64;
+    lat_samples = malloc(LAT_SAMPLES * sizeof(*lat_samples));
+    if (!lat_samples) return 1;
+
+    printf("benchmark,param,threads,value,unit\n");
+    bench_spsc_ops();
+    bench_brdct_ops();
+    bench_spsc_latency();
+
+    free(lat_samples);
+    return 0;
+}
@@ -68,17 +68,106 @@ typedef struct
     size_t len;
 } Slice;
 
+// Under churn (dozens of readers attaching and committing at once) the
+// naked CAS retry loops below livelock-spiral: every loser reloads and
+// collides again on the next cycle. Each loop therefore backs off
+// between retries with randomized exponential pause escalating to a
+// thread yield, which spreads the retries out in time; the uncontended
+// path costs nothing, since the backoff state is a local that is never
+// touched when the first CAS lands. On LL/SC machines (ARM, RISC-V)
+// compare_exchange_strong wraps its own retry loop around the
+// exclusive pair, pure overhead inside a loop that recomputes anyway,
+// so those targets use the weak variant; BRDCT_CAS can be overridden.
+#ifndef BRDCT_CAS
+#if defined(__aarch64__) || defined(__arm__) || defined(__riscv)
+#define BRDCT_CAS atomic_compare_exchange_weak_explicit
+#else
+#define BRDCT_CAS atomic_compare_exchange_strong_explicit
+#endif
+#endif
+
+#ifndef BRDCT_BACKOFF_CAP_LG2
+#define BRDCT_BACKOFF_CAP_LG2 10
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sched.h>
+#define BRDCT_YIELD() sched_yield()
+#else
+#define BRDCT_YIELD() brdct_cpu_relax()
+#endif
+
+static inline void brdct_cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+typedef struct { uint32_t shift, rng; } BrdctBackoff;
+
+/* One backoff step: pause a random number of cycles, doubling the
+ * range each retry up to 2^BRDCT_BACKOFF_CAP_LG2, then yield the
+ * thread instead. Zero-initialize the state per CAS loop; the first
+ * step seeds the LCG from the state's stack address, so contending
+ * threads draw different sequences and do not re-collide in lockstep. */
+static void brdct_backoff(BrdctBackoff *b)
+{
+    if (b->shift >= BRDCT_BACKOFF_CAP_LG2)
+    {
+        BRDCT_YIELD();
+        return;
+    }
+    if (!b->rng)
+        b->rng = (uint32_t)((uintptr_t)b >> 4) * 2654435761u | 1u;
+    b->shift += 1;
+    b->rng = b->rng * 1664525u + 1013904223u;
+    for (uint32_t spins = b->rng >> (32 - b->shift); spins; spins--)
+        brdct_cpu_relax();
+}
+
+// Opt-in instrumentation: define BRDCT_STATS to count, per thread and
+// per translation unit, how often each CAS loop retries. The counters
+// are thread-local plain increments — nothing shared on the hot path —
+// and everything compiles away without the define. Harvest from the
+// owning thread with brdct_cas_stats_snapshot; the retry distribution
+// across deployments is the signal for sizing caplg2.
+#ifdef BRDCT_STATS
+typedef struct
+{
+    size_t attach_retries;
+    size_t detach_retries;
+    size_t reader_commit_retries;
+    size_t writer_slice_retries;
+    size_t writer_commit_retries;
+} BrdctCasStats;
+static _Thread_local BrdctCasStats brdct_cas_stats;
+#define BRDCT_STATS_RETRY(f) (brdct_cas_stats.f += 1)
+/* Copies this thread's counters into [out] and restarts them. */
+static void brdct_cas_stats_snapshot(BrdctCasStats *out)
+{
+    *out = brdct_cas_stats;
+    brdct_cas_stats = (BrdctCasStats){0};
+}
+#else
+#define BRDCT_STATS_RETRY(f) ((void)0)
+#endif
+
 static int brdct_attach_reader(Broadcast *brc, unsigned char caplg2, Reader *r)
 {
     Broadcast curr, new;
+    BrdctBackoff bo = {0, 0};
     curr.raw = atomic_load_explicit(&brc->raw, memory_order_relaxed);
     do
     {
         if (curr.nreaders == ((1 << 15) - 1) >> BRDCT_RESIZE) return -1;
         new = curr;
         new.nreaders += 1;
-    } while (!atomic_compare_exchange_strong_explicit(&brc->raw, &curr.raw,
-        new.raw, memory_order_acq_rel, memory_order_relaxed));
+    } while (!BRDCT_CAS(&brc->raw, &curr.raw,
+        new.raw, memory_order_acq_rel, memory_order_relaxed)
+        && (BRDCT_STATS_RETRY(attach_retries), brdct_backoff(&bo), 1));
     
     brdct_t halflen = (brdct_t)1 << (caplg2 - 1);
     *r = (new.tail & -halflen) - halflen * new.hstate;
@@ -89,6 +178,7 @@ static int brdct_attach_reader(Broadcast *brc, unsigned char caplg2, Reader *r)
 static void brdct_detach_reader(Broadcast *brc, unsigned char caplg2, Reader *r)
 {
     Broadcast curr, new;
+    BrdctBackoff bo = {0, 0};
     curr.raw = atomic_load_explicit(&brc->raw, memory_order_relaxed);
     do
     {
@@ -96,8 +186,9 @@ static void brdct_detach_reader(Broadcast *brc, unsigned char caplg2, Reader *r)
         new.nreaders -= 1;
         if (new.hstate && new.tail >> (caplg2 - 1) == *r >> (caplg2 - 1))
             new.ncycled -= 1;
-    } while (!atomic_compare_exchange_strong_explicit(&brc->raw, &curr.raw,
-        new.raw, memory_order_acq_rel, memory_order_relaxed));
+    } while (!BRDCT_CAS(&brc->raw, &curr.raw,
+        new.raw, memory_order_acq_rel, memory_order_relaxed)
+        && (BRDCT_STATS_RETRY(detach_retries), brdct_backoff(&bo), 1));
 }
 
 static Slice brdct_reader_slice(Broadcast *brc, unsigned char caplg2, Reader *r)
@@ -124,18 +215,21 @@ static void brdct_reader_commit(Broadcast *brc, unsigned char caplg2, Reader *r,
     if (*r >> (caplg2 - 1) == prev >> (caplg2 - 1)) return;
     
     Broadcast curr, new;
+    BrdctBackoff bo = {0, 0};
     curr.raw = atomic_load_explicit(&brc->raw, memory_order_relaxed);
     do
     {
         new = curr;
         new.ncycled += 1;
-    } while (!atomic_compare_exchange_strong_explicit(&brc->raw, &curr.raw,
-        new.raw, memory_order_acq_rel, memory_order_relaxed));
+    } while (!BRDCT_CAS(&brc->raw, &curr.raw,
+        new.raw, memory_order_acq_rel, memory_order_relaxed)
+        && (BRDCT_STATS_RETRY(reader_commit_retries), brdct_backoff(&bo), 1));
 }
 
 static Slice brdct_writer_slice(Broadcast *brc, unsigned char caplg2)
 {
     Broadcast curr, new;
+    BrdctBackoff bo = {0, 0};
     curr.raw = atomic_load_explicit(&brc->raw, memory_order_acquire);
     do
     {
@@ -143,8 +237,9 @@ static Slice brdct_writer_slice(Broadcast *brc, unsigned char caplg2)
         if (new.nreaders == 0 || new.ncycled < new.nreaders) break;
         new.ncycled = 0;
         new.hstate = 0;
-    } while (!atomic_compare_exchange_strong_explicit(&brc->raw, &curr.raw,
-        new.raw, memory_order_acq_rel, memory_order_relaxed));
+    } while (!BRDCT_CAS(&brc->raw, &curr.raw,
+        new.raw, memory_order_acq_rel, memory_order_relaxed)
+        && (BRDCT_STATS_RETRY(writer_slice_retries), brdct_backoff(&bo), 1));
     
     brdct_t halflen = (brdct_t)1 << (caplg2 - 1);
     brdct_t head = (new.tail & -halflen) - halflen * new.hstate;
@@ -173,6 +268,7 @@ static void brdct_writer_commit(Broadcast *brc, unsigned char caplg2, Slice *s)
 {
     size_t count = s->len - (s->cnt[0] + s->cnt[1]);
     Broadcast curr, new;
+    BrdctBackoff bo = {0, 0};
     curr.raw = atomic_load_explicit(&brc->raw, memory_order_relaxed);
     do
     {
@@ -180,8 +276,64 @@ static void brdct_writer_commit(Broadcast *brc, unsigned char caplg2, Slice *s)
         new.tail += count;
         if (new.tail >> (caplg2 - 1) != curr.tail >> (caplg2 - 1))
             new.hstate = 1;
-    } while (!atomic_compare_exchange_strong_explicit(&brc->raw, &curr.raw,
-        new.raw, memory_order_acq_rel, memory_order_relaxed));
+    } while (!BRDCT_CAS(&brc->raw, &curr.raw,
+        new.raw, memory_order_acq_rel, memory_order_relaxed)
+        && (BRDCT_STATS_RETRY(writer_commit_retries), brdct_backoff(&bo), 1));
+}
+
+/* Returns how many elements the cursor [r] is behind the writer. One
+ * relaxed load of the packed word. The cursor is the reader-private
+ * value, taken by value so a monitoring thread can be handed a
+ * snapshot: have each reader publish its own cursor (an atomic, a
+ * mailbox) and feed the samples here — reading another thread's live
+ * Reader directly would be a data race. */
+static inline size_t brdct_reader_lag(Broadcast *brc, Reader r)
+{
+    Broadcast curr;
+    curr.raw = atomic_load_explicit(&brc->raw, memory_order_relaxed);
+    return (size_t)(curr.tail - r);
+}
+
+/* Returns the number of elements the slowest reader has not consumed
+ * (the writer's view of ring occupancy), from one relaxed load.
+ * Derived from the same head reconstruction brdct_writer_slice uses:
+ * head = (tail & -halflen) - halflen * hstate. */
+static inline size_t brdct_occupancy(Broadcast *brc, unsigned char caplg2)
+{
+    Broadcast curr;
+    curr.raw = atomic_load_explicit(&brc->raw, memory_order_relaxed);
+    brdct_t halflen = (brdct_t)1 << (caplg2 - 1);
+    return (size_t)((curr.tail & (halflen - 1)) + halflen * curr.hstate);
+}
+
+typedef struct
+{
+    atomic_size_t hwm;        // highest occupancy sampled so far
+    atomic_size_t halfcycles; // half-blocks the writer has crossed
+    size_t last_tail;         // writer-private progress marker
+} BrdctStats;
+
+/* Writer-side: folds the current occupancy and tail progress of [brc]
+ * into [st]. Call it from the publish loop at whatever period suits;
+ * the stores are relaxed, so the monitoring thread pairs them with
+ * relaxed loads of hwm/halfcycles and the hot path pays no fence. */
+static inline void brdct_stats_sample(BrdctStats *st, Broadcast *brc,
+                               unsigned char caplg2)
+{
+    Broadcast curr;
+    curr.raw = atomic_load_explicit(&brc->raw, memory_order_relaxed);
+    size_t occ = brdct_occupancy(brc, caplg2);
+    if (occ > atomic_load_explicit(&st->hwm, memory_order_relaxed))
+        atomic_store_explicit(&st->hwm, occ, memory_order_relaxed);
+    size_t crossed = (size_t)((curr.tail >> (caplg2 - 1)) -
+        (st->last_tail >> (caplg2 - 1)));
+    if (crossed)
+    {
+        atomic_store_explicit(&st->halfcycles,
+            atomic_load_explicit(&st->halfcycles, memory_order_relaxed)
+                + crossed, memory_order_relaxed);
+        st->last_tail = (size_t)curr.tail;
+    }
 }
 
 #undef brdct_t
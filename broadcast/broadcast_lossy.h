@@ -0,0 +1,150 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BROADCAST_LOSSY_H
+#define BROADCAST_LOSSY_H
+
+/* An overwriting (lossy) broadcast mode.
+ * In broadcast.h one stalled reader freezes the writer: production
+ * stops once the slowest reader is a full cycle behind. Here the
+ * contract is inverted — the writer never waits and a slow reader
+ * loses elements instead. Some notable facts:
+ *
+ * 1: The writer's only state is tail. There is no reader registry, no
+ *      ncycled handshake, no CAS anywhere: readers are free riders
+ *      that keep a private cursor, so any number may attach or vanish
+ *      without the writer noticing. Writer latency is bounded by
+ *      construction.
+ * 2: The writer is handed at most half a capacity per slice. It
+ *      scribbles slots before committing tail, so the region it may
+ *      be touching at any instant is [tail, tail + cap/2): everything
+ *      older than tail - cap/2 must be treated as gone. This mirrors
+ *      the half-block granularity broadcast.h already works in.
+ * 3: A reader detects loss at two points. At slice time: if tail has
+ *      advanced more than cap/2 past the cursor, the window has moved
+ *      on; the cursor resyncs to a quarter capacity behind tail
+ *      (leaving runway before the next overrun) and the number of
+ *      lost elements is reported through [*lost].
+ * 4: And at commit time: the writer may have entered the region
+ *      while the reader was still copying it, tearing the copy.
+ *      brdct_lossy_reader_commit revalidates the region against a
+ *      fresh tail (torn iff tail - cursor > cap/2, since the writer
+ *      touches at most cap/2 past tail) and returns -1 if the copy
+ *      must be discarded, in which case the cursor stays put and the
+ *      next slice call resyncs. The acquire fence before the
+ *      revalidation keeps the copy's reads from drifting past the
+ *      second tail load, seqlock style.
+ * 5: The consumption API is the same two-span Slice; a reader that
+ *      stays within half a capacity of the writer sees exactly the
+ *      broadcast.h behavior, losslessly.
+ */
+
+#include "broadcast.h"
+
+typedef struct { atomic_size_t tail; } BroadcastLossy;
+
+typedef size_t LossyReader;
+
+/* Attaches a reader: just starts its cursor at the current tail. */
+static void brdct_lossy_attach_reader(BroadcastLossy *brc, LossyReader *r)
+{
+    *r = atomic_load_explicit(&brc->tail, memory_order_acquire);
+}
+
+/* Returns the readable region of reader [r] as up to two spans. If the
+ * writer overran the cursor, [*lost] is set to the number of elements
+ * skipped (0 otherwise) and the cursor resyncs to a quarter capacity
+ * behind tail. */
+static Slice brdct_lossy_reader_slice(BroadcastLossy *brc,
+                                      unsigned char caplg2, LossyReader *r,
+                                      size_t *lost)
+{
+    size_t tail = atomic_load_explicit(&brc->tail, memory_order_acquire);
+    size_t cap = (size_t)1 << caplg2;
+    *lost = 0;
+    if (tail - *r > cap / 2)
+    {
+        size_t resync = tail - cap / 4;
+        *lost = resync - *r;
+        *r = resync;
+    }
+    size_t mask = cap - 1;
+    size_t cur = *r;
+    Slice s = { .idx[0] = cur & mask, .cnt[0] = tail - cur };
+    if (tail >> caplg2 != cur >> caplg2)
+    {
+        s.cnt[0] -= tail & mask;
+        s.cnt[1] = tail & mask;
+    }
+    s.len = s.cnt[0] + s.cnt[1];
+
+    return s;
+}
+
+/* Commits the consumed prefix of slice [s] for reader [r] after the
+ * reader copied it out. Returns 0 if the copy is intact, -1 if the
+ * writer overtook the region during the copy: the copy must be
+ * discarded, the cursor does not advance and the next slice call will
+ * resync and account the loss. */
+static int brdct_lossy_reader_commit(BroadcastLossy *brc,
+                                     unsigned char caplg2, LossyReader *r,
+                                     Slice *s)
+{
+    size_t count = s->len - (s->cnt[0] + s->cnt[1]);
+    atomic_thread_fence(memory_order_acquire);
+    size_t tail = atomic_load_explicit(&brc->tail, memory_order_relaxed);
+    if (tail - *r > ((size_t)1 << caplg2) / 2) return -1;
+    *r += count;
+
+    return 0;
+}
+
+/* Returns the writable region: half a capacity from tail, regardless
+ * of any reader (see point 2 for why not the full capacity). */
+static Slice brdct_lossy_writer_slice(BroadcastLossy *brc,
+                                      unsigned char caplg2)
+{
+    size_t tail = atomic_load_explicit(&brc->tail, memory_order_relaxed);
+    size_t cap = (size_t)1 << caplg2;
+    size_t mask = cap - 1;
+    size_t n = cap / 2;
+    size_t idx = tail & mask;
+    Slice s = { .idx[0] = idx,
+        .cnt[0] = cap - idx < n ? cap - idx : n };
+    s.cnt[1] = n - s.cnt[0];
+    s.len = n;
+
+    return s;
+}
+
+/* Publishes the filled prefix of slice [s]: one release store. */
+static inline void brdct_lossy_writer_commit(BroadcastLossy *brc,
+                                             Slice *s)
+{
+    size_t count = s->len - (s->cnt[0] + s->cnt[1]);
+    size_t tail = atomic_load_explicit(&brc->tail, memory_order_relaxed);
+    atomic_store_explicit(&brc->tail, tail + count, memory_order_release);
+}
+
+#endif
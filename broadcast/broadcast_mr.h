@@ -0,0 +1,205 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BROADCAST_MR_H
+#define BROADCAST_MR_H
+
+/* A many-reader variant of broadcast.h.
+ * broadcast.h packs all shared state (tail, nreaders, ncycled, hstate)
+ * into one atomic word, which caps readers at a 15-bit field and makes
+ * every reader commit a CAS on that single global word. Past a handful
+ * of readers, that word becomes the hottest line in the process. This
+ * variant trades the one-word elegance for scalability. Some notable
+ * facts:
+ *
+ * 1: Every reader owns a cache-line-isolated cursor slot. A commit is a
+ *      plain release store to the reader's own line: no CAS, no retry,
+ *      no contention with other readers, regardless of reader count.
+ * 2: The writer bounds production by the slowest reader. Instead of the
+ *      ncycled handshake of broadcast.h, it computes the minimum cursor
+ *      over the active slots — lazily: the minimum is cached and only
+ *      recomputed when the cached value no longer leaves room, so the
+ *      O(readers) scan is paid once per drained window, not per publish.
+ * 3: Reader capacity is a compile-time constant (BRDCT_MR_MAX_READERS,
+ *      default 64, overridable), not a packed bit field; memory grows by
+ *      one cache line per slot.
+ * 4: Attach claims a slot with a CAS on its active flag, then publishes
+ *      the starting cursor with a release store. The writer may observe
+ *      the slot active with the previous occupant's stale cursor for a
+ *      moment; the minimum scan discards cursors more than one capacity
+ *      behind tail, so a stale value can only make the writer briefly
+ *      conservative, never unsafe. A new reader starts at the current
+ *      tail, which is always within every bound the writer may have
+ *      already computed without it.
+ * 5: The consumption API is the same two-span Slice as broadcast.h, so
+ *      reader loops port by renaming the calls.
+ */
+
+#include "broadcast.h"
+
+#ifndef BRDCT_MR_MAX_READERS
+#define BRDCT_MR_MAX_READERS 64
+#endif
+
+#ifndef BRDCT_MR_CACHELINE
+#define BRDCT_MR_CACHELINE 64
+#endif
+
+typedef struct
+{
+    struct __attribute__((aligned(BRDCT_MR_CACHELINE)))
+    {
+        atomic_size_t cursor;
+        atomic_size_t active;
+    } slot[BRDCT_MR_MAX_READERS];
+    // Writer-owned line: tail plus the cached minimum reader cursor.
+    struct __attribute__((aligned(BRDCT_MR_CACHELINE)))
+    {
+        atomic_size_t tail;
+        size_t head_cache;
+    } w;
+} BroadcastMr;
+
+typedef int MrReader;
+
+/* Recomputes the minimum cursor over the active reader slots of [brc],
+ * relative to the writer's tail. With no active reader the writer is
+ * unbounded and the minimum is tail itself. */
+static size_t brdct_mr_min_cursor(BroadcastMr *brc, unsigned char caplg2)
+{
+    size_t tail = atomic_load_explicit(&brc->w.tail, memory_order_relaxed);
+    size_t min = tail;
+    for (int i = 0; i < BRDCT_MR_MAX_READERS; i++)
+    {
+        if (!atomic_load_explicit(&brc->slot[i].active, memory_order_acquire))
+            continue;
+        size_t c = atomic_load_explicit(&brc->slot[i].cursor,
+            memory_order_acquire);
+        // A cursor more than one capacity behind tail is a stale value
+        // from an attach in flight (see point 4); the real cursor is at
+        // tail, so skipping it is exact, not just safe.
+        if (tail - c > (size_t)1 << caplg2) continue;
+        if (tail - c > tail - min) min = c;
+    }
+    return min;
+}
+
+/* Attaches a reader to [brc], storing its slot handle in [*r]. The
+ * reader starts at the current tail. Returns 0 on success, -1 if all
+ * BRDCT_MR_MAX_READERS slots are taken. */
+static int brdct_mr_attach_reader(BroadcastMr *brc, MrReader *r)
+{
+    for (int i = 0; i < BRDCT_MR_MAX_READERS; i++)
+    {
+        size_t expect = 0;
+        if (!atomic_compare_exchange_strong_explicit(&brc->slot[i].active,
+                &expect, 1, memory_order_acquire, memory_order_relaxed))
+            continue;
+        size_t tail = atomic_load_explicit(&brc->w.tail,
+            memory_order_acquire);
+        atomic_store_explicit(&brc->slot[i].cursor, tail,
+            memory_order_release);
+        *r = i;
+        return 0;
+    }
+    return -1;
+}
+
+/* Detaches reader [r] from [brc], freeing its slot. */
+static void brdct_mr_detach_reader(BroadcastMr *brc, MrReader r)
+{
+    atomic_store_explicit(&brc->slot[r].active, 0, memory_order_release);
+}
+
+/* Returns the elements published and not yet consumed by reader [r] as
+ * up to two {index, count} spans, exactly like brdct_reader_slice. */
+static Slice brdct_mr_reader_slice(BroadcastMr *brc, unsigned char caplg2,
+                                   MrReader r)
+{
+    size_t tail = atomic_load_explicit(&brc->w.tail, memory_order_acquire);
+    size_t cur = atomic_load_explicit(&brc->slot[r].cursor,
+        memory_order_relaxed);
+    size_t mask = ((size_t)1 << caplg2) - 1;
+    Slice s = { .idx[0] = cur & mask, .cnt[0] = tail - cur };
+    if (tail >> caplg2 != cur >> caplg2)
+    {
+        s.cnt[0] -= tail & mask;
+        s.cnt[1] = tail & mask;
+    }
+    s.len = s.cnt[0] + s.cnt[1];
+
+    return s;
+}
+
+/* Commits the consumed prefix of slice [s] for reader [r]: one release
+ * store to the reader's own cache line. */
+static inline void brdct_mr_reader_commit(BroadcastMr *brc, MrReader r,
+                                          Slice *s)
+{
+    size_t count = s->len - (s->cnt[0] + s->cnt[1]);
+    size_t cur = atomic_load_explicit(&brc->slot[r].cursor,
+        memory_order_relaxed);
+    atomic_store_explicit(&brc->slot[r].cursor, cur + count,
+        memory_order_release);
+}
+
+/* Returns the writable region of [brc] as up to two {index, count}
+ * spans, bounded by the slowest active reader. The cached minimum is
+ * refreshed only when it no longer leaves room. */
+static Slice brdct_mr_writer_slice(BroadcastMr *brc, unsigned char caplg2)
+{
+    size_t tail = atomic_load_explicit(&brc->w.tail, memory_order_relaxed);
+    size_t cap = (size_t)1 << caplg2;
+    if (cap - (tail - brc->w.head_cache) <= 1)
+        brc->w.head_cache = brdct_mr_min_cursor(brc, caplg2);
+    size_t head = brc->w.head_cache;
+    size_t mask = cap - 1;
+    Slice s = { .idx[0] = tail & mask, .cnt[0] = cap - (tail - head) };
+    if (tail >> caplg2 == head >> caplg2)
+    {
+        s.cnt[0] -= head & mask;
+        s.cnt[1] = head & mask;
+    }
+    s.len = s.cnt[0] + s.cnt[1];
+
+    // Blocks productions that would lead to a full queue.
+    if (tail + s.len - head == cap)
+    {
+        s.len -= 1;
+        if (s.cnt[1] > 0) s.cnt[1] -= 1;
+        else if (s.cnt[0] > 0) s.cnt[0] -= 1;
+    }
+
+    return s;
+}
+
+/* Publishes the filled prefix of slice [s]: one release store of tail. */
+static inline void brdct_mr_writer_commit(BroadcastMr *brc, Slice *s)
+{
+    size_t count = s->len - (s->cnt[0] + s->cnt[1]);
+    size_t tail = atomic_load_explicit(&brc->w.tail, memory_order_relaxed);
+    atomic_store_explicit(&brc->w.tail, tail + count, memory_order_release);
+}
+
+#endif
@@ -0,0 +1,117 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BROADCAST_MW_H
+#define BROADCAST_MW_H
+
+/* A multi-writer broadcast ring.
+ * broadcast.h and broadcast_mr.h assume a single writer; funneling
+ * several producers through a relay ring adds a hop, a copy and a
+ * core. Here producers publish directly into one ring. Some notable
+ * facts:
+ *
+ * 1: Two counters replace the single tail: claim hands out disjoint
+ *      regions with one relaxed fetch-add (no CAS loop, no retry, same
+ *      ticket idea as mpmc_queue.h), and tail is the contiguous
+ *      published frontier the readers see. A writer that finished
+ *      filling its region waits for tail to reach its claim start,
+ *      then advances it past its region with one release store, so
+ *      regions become visible in claim order with no gaps.
+ * 2: The reader side is broadcast_mr.h unchanged: pass &brc->mr to
+ *      the brdct_mr_* reader functions. Readers never see a claimed
+ *      but unpublished region because they only read up to tail.
+ * 3: Space is gated at claim time: the claimant spins until the
+ *      slowest reader leaves room for its whole region. The fetch-add
+ *      is unconditional, so like mpmc_queue_push this blocks rather
+ *      than fails when the ring is full — the claim cannot be backed
+ *      out without reintroducing the CAS loop. [len] must not exceed
+ *      the capacity.
+ * 4: The shared minimum-cursor cache is an acquire/release atomic any
+ *      writer may refresh. The true minimum only grows, so a racing
+ *      stale store can only make claimants conservative; the release
+ *      store carries the refresher's view of the readers' cursors, so
+ *      a claimant that trusts the cache also inherits the
+ *      happens-before edge that lets it reuse the freed slots.
+ * 5: In-order publication means one slow writer delays later ones,
+ *      the price of a gap-free frontier (the LMAX trade). Keep the
+ *      fill between claim and publish short.
+ */
+
+#include "broadcast_mr.h"
+
+typedef struct
+{
+    BroadcastMr mr;
+    struct __attribute__((aligned(BRDCT_MR_CACHELINE)))
+    {
+        atomic_size_t claim;
+        atomic_size_t head_cache;
+    } c;
+} BroadcastMw;
+
+/* Claims [len] slots, spinning until the slowest reader leaves room,
+ * and fills [*s] with the region's two spans. Returns the claim start
+ * to pass to brdct_mw_publish. */
+static size_t brdct_mw_claim(BroadcastMw *brc, unsigned char caplg2,
+                             size_t len, Slice *s)
+{
+    size_t cap = (size_t)1 << caplg2;
+    size_t start = atomic_fetch_add_explicit(&brc->c.claim, len,
+        memory_order_relaxed);
+    for (;;)
+    {
+        size_t head = atomic_load_explicit(&brc->c.head_cache,
+            memory_order_acquire);
+        if (start + len - head <= cap) break;
+        head = brdct_mr_min_cursor(&brc->mr, caplg2);
+        atomic_store_explicit(&brc->c.head_cache, head,
+            memory_order_release);
+        if (start + len - head <= cap) break;
+    }
+    size_t mask = cap - 1;
+    size_t idx = start & mask;
+    s->idx[0] = idx;
+    s->cnt[0] = cap - idx < len ? cap - idx : len;
+    s->idx[1] = 0;
+    s->cnt[1] = len - s->cnt[0];
+    s->len = len;
+
+    return start;
+}
+
+/* Publishes the region claimed at [start] of length [len]: spins until
+ * every earlier claim is published, then advances the frontier with
+ * one release store. */
+static void brdct_mw_publish(BroadcastMw *brc, size_t start, size_t len)
+{
+    // acquire: chains the previous writer's release so our release
+    // store carries its region's data to the readers too
+    while (atomic_load_explicit(&brc->mr.w.tail, memory_order_acquire)
+            != start)
+        ;
+    atomic_store_explicit(&brc->mr.w.tail, start + len,
+        memory_order_release);
+}
+
+#endif
@@ -0,0 +1,178 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BROADCAST_SHM_H
+#define BROADCAST_SHM_H
+
+/* A multi-process mode for the broadcast ring.
+ * All ring state is position-independent (counters and flags, no
+ * pointers), so the structures work in a shared mapping as-is. What a
+ * shared segment adds is a failure mode: a reader process dying
+ * between attach and detach would stall the writer forever. This
+ * module provides the segment plumbing and a robust-cleanup story.
+ * Some notable facts:
+ *
+ * 1: The ring is a BroadcastMr, not the packed-word Broadcast: its
+ *      per-reader slots already hold each reader's cursor in shared
+ *      memory, which is exactly what an evictor needs — reclaiming a
+ *      dead reader is one release store of its active flag, identical
+ *      to a voluntary detach.
+ * 2: Liveness is per-slot PID. brdct_shm_evict_dead probes each
+ *      active slot's owner with kill(pid, 0) and detaches readers
+ *      whose process is gone (ESRCH). The writer calls it when
+ *      brdct_mr_writer_slice comes back empty, so eviction costs
+ *      nothing until a reader actually blocks progress. PID reuse can
+ *      in principle spare a dead reader's slot until that reader
+ *      stalls the writer again; a stronger heartbeat can be layered
+ *      on top if that matters.
+ * 3: The PID word is the claim token: attach CASes it from 0 to
+ *      getpid(), publishes the cursor, then sets the active flag, so
+ *      every claimed slot is probeable from the moment it is claimed —
+ *      a process dying at any point after the CAS is reclaimed by the
+ *      evictor, with no unprobeable in-flight window. Detach and
+ *      eviction go the other way: active first, PID last, so the claim
+ *      is only released once the slot is no longer honored.
+ * 4: The segment is sized by brdct_shm_size: the ring state followed
+ *      by a byte ring of 2^caplg2. Create it once with
+ *      brdct_shm_create (shm_open O_EXCL, so exactly one writer wins)
+ *      and map it elsewhere with brdct_shm_open; publish cost is
+ *      unchanged, since nothing on the hot path knows it is in a
+ *      shared mapping.
+ */
+
+#include <errno.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "broadcast_mr.h"
+
+typedef struct
+{
+    BroadcastMr mr;
+    atomic_int pid[BRDCT_MR_MAX_READERS];
+    unsigned char data[];
+} BroadcastShm;
+
+static inline size_t brdct_shm_size(unsigned char caplg2)
+{
+    return sizeof(BroadcastShm) + ((size_t)1 << caplg2);
+}
+
+/* Creates and maps the shared segment [name] for a ring of 2^[caplg2]
+ * bytes. Fails (NULL) if it already exists, so one writer owns setup. */
+static BroadcastShm *brdct_shm_create(const char *name,
+                                      unsigned char caplg2)
+{
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) return 0;
+    if (ftruncate(fd, (off_t)brdct_shm_size(caplg2)) < 0)
+    {
+        close(fd);
+        shm_unlink(name);
+        return 0;
+    }
+    void *p = mmap(0, brdct_shm_size(caplg2), PROT_READ | PROT_WRITE,
+        MAP_SHARED, fd, 0);
+    close(fd);
+    return p == MAP_FAILED ? 0 : (BroadcastShm *)p;
+}
+
+/* Maps the existing shared segment [name]. */
+static BroadcastShm *brdct_shm_open(const char *name, unsigned char caplg2)
+{
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd < 0) return 0;
+    void *p = mmap(0, brdct_shm_size(caplg2), PROT_READ | PROT_WRITE,
+        MAP_SHARED, fd, 0);
+    close(fd);
+    return p == MAP_FAILED ? 0 : (BroadcastShm *)p;
+}
+
+static void brdct_shm_close(BroadcastShm *shm, unsigned char caplg2)
+{
+    munmap(shm, brdct_shm_size(caplg2));
+}
+
+static int brdct_shm_unlink(const char *name)
+{
+    return shm_unlink(name);
+}
+
+/* Attaches this process as a reader, claiming a slot by PID so the
+ * evictor can always probe it. Returns 0 on success, -1 if all slots
+ * are taken. */
+static int brdct_shm_attach_reader(BroadcastShm *shm, MrReader *r)
+{
+    for (int i = 0; i < BRDCT_MR_MAX_READERS; i++)
+    {
+        int expect = 0;
+        if (!atomic_compare_exchange_strong_explicit(&shm->pid[i],
+                &expect, (int)getpid(), memory_order_acquire,
+                memory_order_relaxed))
+            continue;
+        size_t tail = atomic_load_explicit(&shm->mr.w.tail,
+            memory_order_acquire);
+        atomic_store_explicit(&shm->mr.slot[i].cursor, tail,
+            memory_order_release);
+        atomic_store_explicit(&shm->mr.slot[i].active, 1,
+            memory_order_release);
+        *r = i;
+        return 0;
+    }
+    return -1;
+}
+
+/* Detaches reader [r]: the slot stops being honored first, and the PID
+ * clear last releases the claim for the next attacher. */
+static void brdct_shm_detach_reader(BroadcastShm *shm, MrReader r)
+{
+    atomic_store_explicit(&shm->mr.slot[r].active, 0,
+        memory_order_release);
+    atomic_store_explicit(&shm->pid[r], 0, memory_order_release);
+}
+
+/* Writer-side: detaches every claimed reader whose process no longer
+ * exists. Returns the number of evicted readers. Call it when the
+ * writer slice comes back empty, or on a timer. */
+static int brdct_shm_evict_dead(BroadcastShm *shm)
+{
+    int evicted = 0;
+    for (int i = 0; i < BRDCT_MR_MAX_READERS; i++)
+    {
+        int pid = atomic_load_explicit(&shm->pid[i], memory_order_acquire);
+        if (pid == 0) continue; // free slot
+        if (kill((pid_t)pid, 0) < 0 && errno == ESRCH)
+        {
+            atomic_store_explicit(&shm->mr.slot[i].active, 0,
+                memory_order_release);
+            atomic_store_explicit(&shm->pid[i], 0, memory_order_release);
+            evicted++;
+        }
+    }
+    return evicted;
+}
+
+#endif
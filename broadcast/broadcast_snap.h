@@ -0,0 +1,129 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BROADCAST_SNAP_H
+#define BROADCAST_SNAP_H
+
+/* Snapshot-plus-delta attach for late joiners on broadcast.h.
+ * brdct_attach_reader starts a new reader at the current half-block
+ * boundary, so a late joiner misses all earlier history and must
+ * recover state out of band. Here the writer periodically publishes a
+ * state snapshot into a side buffer, versioned and tied to a ring
+ * position, and a joiner atomically gets the snapshot plus the exact
+ * cursor to resume deltas from — no gap, no overlap. Some notable
+ * facts:
+ *
+ * 1: The side buffer is a seqlock (the torn-copy-and-revalidate
+ *      pattern of broadcast_lossy.h): the writer bumps seq to odd with
+ *      an acq_rel RMW before touching the buffer and to even with a
+ *      release store after, and the joiner copies, fences acquire, and
+ *      rereads seq. A torn copy is retried, never returned.
+ * 2: The snapshot records the writer's tail at publish time. The
+ *      joiner attaches FIRST, pinning the retention window, then reads
+ *      the snapshot and fast-forwards its cursor to the recorded
+ *      position through the official brdct_reader_commit (an
+ *      all-consumed slice of length pos - cursor), so the ncycled
+ *      bookkeeping stays exact. Snapshot covers everything before pos,
+ *      deltas cover everything after: the boundary is one element
+ *      wide and shared by neither.
+ * 3: If the recorded position lies outside the joiner's readable
+ *      window the snapshot predates the attach boundary and resuming
+ *      from it would leave a gap; attach fails (-1, reader detached)
+ *      and the caller retries. A writer that snapshots at least once
+ *      per half-lap of the ring makes that window miss impossible in
+ *      steady state.
+ * 4: Snapshot cost is paid by the writer (one memcpy per publish) and
+ *      one memcpy per join — against seconds of out-of-band transfer.
+ *      Size the publish period against the snapshot length: the side
+ *      buffer is copied whole each time.
+ */
+
+#include <string.h>
+#include "broadcast.h"
+
+typedef struct
+{
+    atomic_size_t seq; // odd while the writer is updating
+    size_t pos;        // the writer's tail the snapshot reflects
+    size_t len;        // snapshot bytes currently in the side buffer
+} BrdctSnap;
+
+/* Writer-side: publishes [len] bytes of [state] into the side buffer
+ * [snapbuf], versioned against the current tail of [brc]. Call it from
+ * the writer thread, at least once per half-lap. */
+static void brdct_snap_publish(BrdctSnap *sn, unsigned char *snapbuf,
+                               Broadcast *brc, const unsigned char *state,
+                               size_t len)
+{
+    Broadcast curr;
+    curr.raw = atomic_load_explicit(&brc->raw, memory_order_relaxed);
+    atomic_fetch_add_explicit(&sn->seq, 1, memory_order_acq_rel);
+    memcpy(snapbuf, state, len);
+    sn->pos = (size_t)curr.tail;
+    sn->len = len;
+    atomic_store_explicit(&sn->seq,
+        atomic_load_explicit(&sn->seq, memory_order_relaxed) + 1,
+        memory_order_release);
+}
+
+/* Attaches a reader to [brc] and hands it a consistent snapshot: the
+ * state bytes are copied into [out] (at most [max]; the actual length
+ * lands in [*outlen]) and the reader's cursor is advanced to the exact
+ * position the snapshot reflects, so the first slice it reads is the
+ * first delta after the snapshot. Returns 0, or -1 with the reader
+ * detached if the ring is at reader capacity, the snapshot does not
+ * fit, or it is too old to resume from (see fact 3). */
+static int brdct_attach_reader_snap(Broadcast *brc, BrdctSnap *sn,
+                                    const unsigned char *snapbuf,
+                                    unsigned char caplg2, Reader *r,
+                                    unsigned char *out, size_t max,
+                                    size_t *outlen)
+{
+    if (brdct_attach_reader(brc, caplg2, r)) return -1;
+    size_t pos, len;
+    for (;;)
+    {
+        size_t s1 = atomic_load_explicit(&sn->seq, memory_order_acquire);
+        if (s1 & 1) continue;
+        pos = sn->pos;
+        len = sn->len;
+        if (len <= max) memcpy(out, snapbuf, len);
+        atomic_thread_fence(memory_order_acquire);
+        if (atomic_load_explicit(&sn->seq, memory_order_relaxed) == s1)
+            break;
+    }
+    Slice s = brdct_reader_slice(brc, caplg2, r);
+    size_t skip = (Reader)((Reader)pos - *r);
+    if (len > max || skip > s.len)
+    {
+        brdct_detach_reader(brc, caplg2, r);
+        return -1;
+    }
+    Slice ff = { .len = skip }; // all-consumed: commits exactly skip
+    brdct_reader_commit(brc, caplg2, r, &ff);
+    *outlen = len;
+    return 0;
+}
+
+#endif
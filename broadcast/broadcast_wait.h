@@ -0,0 +1,155 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef BROADCAST_WAIT_H
+#define BROADCAST_WAIT_H
+
+/* Reader parking for broadcast.h, the fanout twin of queue_wait.h.
+ * Idle subscribers looping on brdct_reader_slice burn a core each when
+ * the feed is quiet. Here a reader spins a bounded number of rounds
+ * and then sleeps in the kernel; the writer wakes the sleepers with a
+ * single broadcast, and only when someone is actually parked. Some
+ * notable facts:
+ *
+ * 1: The parked word is an eventcount-style counter of sleeping
+ *      readers and doubles as the 32-bit kernel wait word. With
+ *      nobody parked, brdct_writer_commit_wake is exactly
+ *      brdct_writer_commit plus one RELAXED load — no syscall, no
+ *      extra shared-line write on the publish path.
+ * 2: The reader does the expensive ordering work: it registers with a
+ *      SEQ_CST increment, rechecks the slice, and only then sleeps,
+ *      so a publish that completed before registration is never slept
+ *      through. The same store-load race as in queue_wait.h point 3
+ *      remains on the waker side and is bounded the same way: every
+ *      kernel wait carries a BRDCT_WAIT_BACKSTOP_NS timeout instead
+ *      of taxing the publish path with a fence.
+ * 3: A wake is a broadcast (all sleepers), since any publish may
+ *      satisfy any subset of readers; each reader re-derives its own
+ *      slice on wakeup and may park again.
+ */
+
+#include <stdint.h>
+#include "broadcast.h"
+
+#ifndef BRDCT_WAIT_SPIN
+#define BRDCT_WAIT_SPIN 1024
+#endif
+
+#ifndef BRDCT_WAIT_BACKSTOP_NS
+#define BRDCT_WAIT_BACKSTOP_NS 1000000
+#endif
+
+typedef struct
+{
+    Broadcast b;
+    uint32_t parked;
+} BroadcastWait;
+
+#if defined(__linux__)
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <limits.h>
+#include <time.h>
+
+static void brdct_wait_kernel(uint32_t *word, uint32_t expected)
+{
+    struct timespec ts = { 0, BRDCT_WAIT_BACKSTOP_NS };
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, &ts, 0, 0);
+}
+
+static void brdct_wake_kernel(uint32_t *word)
+{
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, INT_MAX, 0, 0, 0);
+}
+
+#elif defined(_WIN32)
+
+// Requires linking against Synchronization.lib (WaitOnAddress family).
+#include <windows.h>
+
+static void brdct_wait_kernel(uint32_t *word, uint32_t expected)
+{
+    WaitOnAddress(word, &expected, sizeof(*word),
+        BRDCT_WAIT_BACKSTOP_NS / 1000000);
+}
+
+static void brdct_wake_kernel(uint32_t *word)
+{
+    WakeByAddressAll(word);
+}
+
+#else
+
+#include <time.h>
+
+static void brdct_wait_kernel(uint32_t *word, uint32_t expected)
+{
+    (void)word; (void)expected;
+    struct timespec ts = { 0, BRDCT_WAIT_BACKSTOP_NS };
+    nanosleep(&ts, 0);
+}
+
+static void brdct_wake_kernel(uint32_t *word) { (void)word; }
+
+#endif
+
+/* Like brdct_reader_slice, but never returns an empty slice: spins for
+ * BRDCT_WAIT_SPIN rounds, then parks until the writer publishes. */
+static Slice brdct_reader_slice_wait(BroadcastWait *wb,
+                                     unsigned char caplg2, Reader *r)
+{
+    for (;;)
+    {
+        for (int i = 0; i < BRDCT_WAIT_SPIN; i++)
+        {
+            Slice s = brdct_reader_slice(&wb->b, caplg2, r);
+            if (s.len) return s;
+        }
+        uint32_t seen = 1 +
+            __atomic_fetch_add(&wb->parked, 1, __ATOMIC_SEQ_CST);
+        Slice s = brdct_reader_slice(&wb->b, caplg2, r);
+        if (s.len)
+        {
+            __atomic_fetch_sub(&wb->parked, 1, __ATOMIC_RELAXED);
+            return s;
+        }
+        brdct_wait_kernel(&wb->parked, seen);
+        __atomic_fetch_sub(&wb->parked, 1, __ATOMIC_RELAXED);
+    }
+}
+
+/* Commits the filled prefix of slice [s] and wakes the parked readers,
+ * if any. Without sleepers this is brdct_writer_commit plus one
+ * relaxed load. */
+static inline void brdct_writer_commit_wake(BroadcastWait *wb,
+                                            unsigned char caplg2, Slice *s)
+{
+    brdct_writer_commit(&wb->b, caplg2, s);
+    if (__atomic_load_n(&wb->parked, __ATOMIC_RELAXED))
+        brdct_wake_kernel(&wb->parked);
+}
+
+#endif
@@ -0,0 +1,160 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SLICE_COPY_H
+#define SLICE_COPY_H
+
+/* Cache-polite bulk copies for slice drains and fills. A logger
+ * draining 64-256KB spans through memcpy pulls all of it through
+ * L1/L2 and evicts a co-located thread's working set. These helpers
+ * use non-temporal stores above a size threshold so the copied bytes
+ * bypass the cache hierarchy. They live in the library because the
+ * fence placement interacts with the rings' release commits. Some
+ * notable facts:
+ *
+ * 1: Non-temporal stores are weakly ordered: a later release store
+ *      does NOT order them, so a producer that fills a ring with NT
+ *      stores and then commits could publish the tail before the data
+ *      reaches memory. Both helpers therefore end with an sfence —
+ *      after slice_copy_nt/slice_fill_nt returns, the usual
+ *      commit/publish calls are safe unchanged.
+ * 2: Only the destination is streamed. The often-suggested movntdqa
+ *      load only bypasses the cache on write-combining memory and is a
+ *      plain load on the normal write-back memory the rings live in,
+ *      so the source side instead gets prefetchnta, which fetches into
+ *      a non-temporal way and minimizes what the copy evicts. The next
+ *      span is prefetched while the current one copies.
+ * 3: Below SLICE_COPY_NT_MIN total bytes (default 32K, about the
+ *      point where the copy stops fitting next to a working set in
+ *      L2) the helpers are plain memcpy: for small drains the streamed
+ *      store's write-combining buffers cost more than the eviction
+ *      they avoid. Without SSE2 everything is memcpy and the fence is
+ *      elided.
+ * 4: The span counts are consumed like any manual fill/drain, so the
+ *      slice can be passed straight to the matching commit, which
+ *      publishes exactly the copied prefix.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include "broadcast.h"
+
+#ifndef SLICE_COPY_NT_MIN
+#define SLICE_COPY_NT_MIN 32768
+#endif
+
+#if defined(__SSE2__)
+
+#include <emmintrin.h>
+
+static void slice_nt_memcpy(unsigned char *dst, const unsigned char *src,
+                            size_t n)
+{
+    while (((uintptr_t)dst & 15) && n)
+    {
+        *dst++ = *src++;
+        n--;
+    }
+    while (n >= 64)
+    {
+        _mm_prefetch((const char *)src + 256, _MM_HINT_NTA);
+        __m128i a = _mm_loadu_si128((const __m128i *)(src + 0));
+        __m128i b = _mm_loadu_si128((const __m128i *)(src + 16));
+        __m128i c = _mm_loadu_si128((const __m128i *)(src + 32));
+        __m128i d = _mm_loadu_si128((const __m128i *)(src + 48));
+        _mm_stream_si128((__m128i *)(dst + 0), a);
+        _mm_stream_si128((__m128i *)(dst + 16), b);
+        _mm_stream_si128((__m128i *)(dst + 32), c);
+        _mm_stream_si128((__m128i *)(dst + 48), d);
+        src += 64;
+        dst += 64;
+        n -= 64;
+    }
+    memcpy(dst, src, n);
+}
+
+#define SLICE_PREFETCH(p) _mm_prefetch((const char *)(p), _MM_HINT_NTA)
+#define SLICE_SFENCE()    _mm_sfence()
+
+#else
+
+#define slice_nt_memcpy(dst, src, n) memcpy(dst, src, n)
+#define SLICE_PREFETCH(p) ((void)(p))
+#define SLICE_SFENCE()    ((void)0)
+
+#endif
+
+/* Drains the whole slice [s] of the ring at [base] (elements of
+ * [esize] bytes) into the contiguous buffer [dst], streaming past the
+ * cache when the slice is SLICE_COPY_NT_MIN bytes or more. Consumes
+ * the span counts and fences, so commit [s] as usual afterwards. */
+static void slice_copy_nt(unsigned char *dst, const unsigned char *base,
+                          size_t esize, Slice *s)
+{
+    int nt = (s->cnt[0] + s->cnt[1]) * esize >= SLICE_COPY_NT_MIN;
+    for (int i = 0; i < 2; i++)
+    {
+        size_t bytes = s->cnt[i] * esize;
+        if (!bytes) continue;
+        if (i == 0 && s->cnt[1])
+            SLICE_PREFETCH(base + s->idx[1] * esize);
+        if (nt) slice_nt_memcpy(dst, base + s->idx[i] * esize, bytes);
+        else memcpy(dst, base + s->idx[i] * esize, bytes);
+        dst += bytes;
+        s->idx[i] += s->cnt[i];
+        s->cnt[i] = 0;
+    }
+    SLICE_SFENCE();
+}
+
+/* Fills up to [n] elements from the contiguous [src] into the writable
+ * slice [s] of the ring at [base], streaming past the cache when the
+ * filled volume is SLICE_COPY_NT_MIN bytes or more. Consumes the span
+ * counts and fences (see fact 1), so publish/commit [s] as usual
+ * afterwards. Returns the number of elements copied in. */
+static size_t slice_fill_nt(unsigned char *base, size_t esize, Slice *s,
+                            const unsigned char *src, size_t n)
+{
+    size_t avail = s->cnt[0] + s->cnt[1];
+    if (n > avail) n = avail;
+    int nt = n * esize >= SLICE_COPY_NT_MIN;
+    size_t left = n;
+    for (int i = 0; i < 2 && left; i++)
+    {
+        size_t run = s->cnt[i] < left ? s->cnt[i] : left;
+        if (!run) continue;
+        if (i == 0 && left > run)
+            SLICE_PREFETCH(src + run * esize);
+        if (nt) slice_nt_memcpy(base + s->idx[i] * esize, src, run * esize);
+        else memcpy(base + s->idx[i] * esize, src, run * esize);
+        src += run * esize;
+        s->idx[i] += run;
+        s->cnt[i] -= run;
+        left -= run;
+    }
+    SLICE_SFENCE();
+    return n;
+}
+
+#endif
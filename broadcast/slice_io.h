@@ -0,0 +1,123 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SLICE_IO_H
+#define SLICE_IO_H
+
+/* Scatter/gather I/O helpers for the two-span Slice of broadcast.h.
+ * A Slice can name two discontiguous spans when the region wraps, so
+ * looping read/write per span doubles the syscalls exactly at the wrap
+ * — the point where the ring is busiest. These helpers turn a Slice
+ * into an iovec pair and drive both spans with one vectored syscall.
+ * Some notable facts:
+ *
+ * 1: slice_iovec works for any element size; the read/write wrappers
+ *      below assume a byte ring (element size 1), which is how test.c
+ *      and every known user feeds sockets and files through these
+ *      structures. With wider elements a short transfer could leave a
+ *      partial element at the span boundary, a problem the caller is
+ *      better placed to resolve than a helper that cannot know the
+ *      framing; build on slice_iovec directly in that case.
+ * 2: The wrappers decrement cnt[0]/cnt[1] by the bytes transferred, so
+ *      the Slice can go straight to brdct_writer_commit (after a fill)
+ *      or brdct_reader_commit (after a flush) and only what the kernel
+ *      actually moved gets published or consumed. Short transfers are
+ *      therefore handled for free by the commit protocol.
+ * 3: Nothing here is broadcast-specific: the QueueSlice of queue.h has
+ *      the same idx/cnt pair and works with slice_iovec via a cast-free
+ *      copy of the two fields, but the wrappers take the broadcast
+ *      Slice since that is where the two-span shape originated.
+ */
+
+#include <sys/uio.h>
+#include <sys/socket.h>
+#include "broadcast.h"
+
+/* Fills [iov] (room for 2) with the spans of [s] over the buffer
+ * [base] holding elements of [esize] bytes. Returns the number of
+ * iovecs filled (0, 1 or 2), suitable as an iovcnt argument. */
+static int slice_iovec(const Slice *s, void *base, size_t esize,
+                       struct iovec iov[2])
+{
+    int n = 0;
+    for (int i = 0; i < 2; i++)
+    {
+        if (s->cnt[i] == 0) continue;
+        iov[n].iov_base = (char *)base + s->idx[i] * esize;
+        iov[n].iov_len = s->cnt[i] * esize;
+        n++;
+    }
+    return n;
+}
+
+/* Consumes [n] bytes from the spans of [s], first span first, so a
+ * following commit publishes exactly the transferred prefix. */
+static void slice_consume(Slice *s, size_t n)
+{
+    size_t c0 = n < s->cnt[0] ? n : s->cnt[0];
+    s->cnt[0] -= c0;
+    s->cnt[1] -= n - c0;
+}
+
+/* Fills both spans of [s] over the byte buffer [base] with a single
+ * readv from [fd]. Returns the readv result; on success the Slice is
+ * ready for brdct_writer_commit. */
+static ssize_t slice_readv(int fd, Slice *s, void *base)
+{
+    struct iovec iov[2];
+    int n = slice_iovec(s, base, 1, iov);
+    if (n == 0) return 0;
+    ssize_t res = readv(fd, iov, n);
+    if (res > 0) slice_consume(s, (size_t)res);
+    return res;
+}
+
+/* Flushes both spans of [s] over the byte buffer [base] with a single
+ * writev to [fd]. Returns the writev result; on success the Slice is
+ * ready for brdct_reader_commit. */
+static ssize_t slice_writev(int fd, Slice *s, void *base)
+{
+    struct iovec iov[2];
+    int n = slice_iovec(s, base, 1, iov);
+    if (n == 0) return 0;
+    ssize_t res = writev(fd, iov, n);
+    if (res > 0) slice_consume(s, (size_t)res);
+    return res;
+}
+
+/* Fills both spans of [s] over the byte buffer [base] with a single
+ * recvmsg from socket [fd] using [flags]. Returns the recvmsg result;
+ * on success the Slice is ready for brdct_writer_commit. */
+static ssize_t slice_recvmsg(int fd, Slice *s, void *base, int flags)
+{
+    struct iovec iov[2];
+    int n = slice_iovec(s, base, 1, iov);
+    if (n == 0) return 0;
+    struct msghdr msg = { .msg_iov = iov, .msg_iovlen = (size_t)n };
+    ssize_t res = recvmsg(fd, &msg, flags);
+    if (res > 0) slice_consume(s, (size_t)res);
+    return res;
+}
+
+#endif
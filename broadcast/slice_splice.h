@@ -0,0 +1,131 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SLICE_SPLICE_H
+#define SLICE_SPLICE_H
+
+/* Ring-to-ring splice: moves elements from a readable slice of one
+ * ring straight into the writable slice of another. A pipeline stage
+ * that pops, copies to scratch and pushes pays two copies per element;
+ * a splice pays one (or zero extra work beyond the transform, when the
+ * stage rewrites the data anyway). Some notable facts:
+ *
+ * 1: Source and destination each come as up to two spans, so a move
+ *      can split four ways. slice_splice walks both span cursors in
+ *      lockstep, copying the largest run both sides allow, so callers
+ *      never see the combinatorics.
+ * 2: Both slices' counts are consumed like a manual fill/drain: after
+ *      the splice, committing each slice on its own ring publishes
+ *      exactly the moved prefix, with the usual acquire/release rules
+ *      of the underlying rings doing the ordering. Nothing here is
+ *      atomic; splice between a slice you own on each side.
+ * 3: The optional callback replaces memcpy per run and sees
+ *      contiguous element runs (dst, src, count), so a stage can
+ *      transform in flight — parse, redact, byte-swap — at the cost it
+ *      would have paid touching the data anyway.
+ * 4: queue.h returns QueueSlice only for the push side; the adapters
+ *      below expose both directions of a queue in the two-span Slice
+ *      shape (queue_drain_slice mirrors queue_reserve with one acquire
+ *      load of tail), so queue-queue, broadcast-queue and
+ *      queue-broadcast splices all go through the one entry point.
+ *      slice_done converts a consumed slice back to the count the
+ *      queue's commit functions take.
+ */
+
+#include <string.h>
+#include "broadcast.h"
+#include "../queue/queue.h"
+
+/* Per-run transform: write [n] elements of [src] into [dst]. */
+typedef void (*SpliceFn)(unsigned char *dst, const unsigned char *src,
+                         size_t n, void *ctx);
+
+/* Moves up to [n] elements of [esize] bytes from slice [s] of the ring
+ * at [sbase] into slice [d] of the ring at [dbase], through [fn] if
+ * given (memcpy otherwise). Consumes both slices' counts; returns the
+ * number of elements moved. */
+static size_t slice_splice(unsigned char *dbase, Slice *d,
+                           const unsigned char *sbase, Slice *s,
+                           size_t esize, size_t n, SpliceFn fn, void *ctx)
+{
+    size_t avail = s->cnt[0] + s->cnt[1];
+    size_t room = d->cnt[0] + d->cnt[1];
+    if (n > avail) n = avail;
+    if (n > room) n = room;
+    size_t left = n;
+    int si = !s->cnt[0], di = !d->cnt[0];
+    while (left)
+    {
+        size_t run = s->cnt[si] < d->cnt[di] ? s->cnt[si] : d->cnt[di];
+        if (run > left) run = left;
+        if (fn) fn(dbase + d->idx[di] * esize,
+            sbase + s->idx[si] * esize, run, ctx);
+        else memcpy(dbase + d->idx[di] * esize,
+            sbase + s->idx[si] * esize, run * esize);
+        s->idx[si] += run; s->cnt[si] -= run;
+        d->idx[di] += run; d->cnt[di] -= run;
+        si |= !s->cnt[si];
+        di |= !d->cnt[di];
+        left -= run;
+    }
+    return n;
+}
+
+/* The consumed prefix of slice [s]: what its commit will publish. */
+static inline size_t slice_done(const Slice *s)
+{
+    return s->len - (s->cnt[0] + s->cnt[1]);
+}
+
+/* The readable region of queue [q] as a two-span Slice, with a single
+ * acquire load of tail (the drain mirror of queue_reserve). Commit
+ * with queue_commit_pop(q, slice_done(&s)). */
+static Slice queue_drain_slice(Queue *q, unsigned char cap_lg2)
+{
+    size_t tail = QUEUE_LOAD(&q->tail);
+    size_t head = QUEUE_RLOAD(&q->head);
+    size_t mask = ((size_t)1 << cap_lg2) - 1;
+    Slice s = { .idx[0] = head & mask, .cnt[0] = tail - head };
+    if (tail >> cap_lg2 != head >> cap_lg2)
+    {
+        s.cnt[0] -= tail & mask;
+        s.cnt[1] = tail & mask;
+    }
+    s.len = s.cnt[0] + s.cnt[1];
+
+    return s;
+}
+
+/* The free region of queue [q] as a two-span Slice (queue_reserve in
+ * the Slice shape). Commit with queue_commit_push(q, slice_done(&s)). */
+static Slice queue_space_slice(Queue *q, unsigned char cap_lg2)
+{
+    QueueSlice r = queue_reserve(q, cap_lg2);
+    Slice s = { .idx[0] = r.idx[0], .idx[1] = r.idx[1],
+        .cnt[0] = r.cnt[0], .cnt[1] = r.cnt[1], .len = r.len };
+
+    return s;
+}
+
+#endif
@@ -0,0 +1,573 @@
+/*
+ * MIT License
+ * 
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ * 
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ * 
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ * 
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef COMMON_H
+#define COMMON_H
+
+/* Single-header amalgamation of queue/queue.h and broadcast/broadcast.h.
+ * Generated by amalgamate.py -- edit the sources, not this file. */
+
+#if defined(_MSC_VER)
+#define COMMON_INLINE static __forceinline
+#define COMMON_UNLIKELY(x) (x)
+#else
+#define COMMON_INLINE static inline __attribute__((always_inline))
+#define COMMON_UNLIKELY(x) __builtin_expect(!!(x), 0)
+#endif
+
+/* An efficient generic queue implementation.
+ * This is suitable for an SPSC scenario with at most two concurrently
+ * executing threads. Some notable facts:
+ *
+ * 1: To correctly represent the ring state you only need two variables:
+ *      head + tail or head + num_elements. You don’t strictly need
+ *      all three of them.
+ * 2: The provided API allows skipping unnecessary user-to-user copies
+ *      when producing and consuming.
+ * 3: By using head + tail instead of head + num_elements, the ring can
+ *      be lock-free. Even though producer and consumer access the same
+ *      variables, each one only updates a single variable. Since a stale
+ *      value still corresponds to a valid ring state, no incorrect states
+ *      are possible. The only requirement is that head and tail must be
+ *      updated with release consistency and read with acquire consistency,
+ *      ensuring the buffer memory is updated before the state variable.
+ *      If head + num_elements were used instead, the consumer would need
+ *      to atomically update both variables after a pop to avoid an
+ *      incorrect state. This would require either a lock or storing both
+ *      variables in a single atomically accessible word, an unnecessary
+ *      complication compared to the head + tail approach.
+ * 4: By restricting the queue length to a power of 2 and storing head
+ *      and tail without applying the modulo, you eliminate the ambiguity
+ *      of whether the ring is empty or full when head == tail.
+ *      - head == tail always means the ring is empty
+ *      - (tail - head) == capacity always means the ring is full
+ *      Even when tail wraps around SIZE_MAX, the implicit (mod SIZE_MAX+1)
+ *      applied to all operations ensures correctness.
+ *      NOTE: If the queue length is not a power of 2, this approach
+ *      produces incorrect states due to the implicit modulo.
+ *      EXAMPLE:
+ *      Suppose the queue size is 3 and head == SIZE_MAX, about to wrap
+ *      back to zero. To pop the next element you access:
+ *      data[head % 3] == data[0], because SIZE_MAX % 3 == 0.
+ *      After the pop, you update head as follows:
+ *      head = head + 1 == 0, because SIZE_MAX + 1 == 0.
+ *      The value of head has advanced, but its numeric value is still zero.
+ * 5: With a power-of-two length, all modulo operations reduce to bitwise
+ *      operations.
+ * 6: With a power-of-two length, you can implement the queue completely
+ *      branchless using bitwise operations.
+ * 7: There is no need to store a pointer to the data buffer in the queue
+ *      state. The queue is fully represented by head and tail. As a result,
+ *      push and pop functions return indices rather than pointers.
+ *      This also provides a key advantage:
+ *      the queue can be used with any data type, since the indices refer
+ *      to positions within the user-defined array.
+ * 8: queue_push reports only the first contiguous run of pushable slots,
+ *      so a producer that wants to fill past the wrap point must call
+ *      queue_push/queue_commit_push once per wrap, paying one acquire
+ *      load of head each time. queue_reserve/queue_publish avoid this:
+ *      one acquire load hands back both spans of the free region at once,
+ *      in the same two-span format the broadcast Slice uses, so a burst
+ *      can be filled across the wrap with a single atomic round-trip.
+ * 9: The atomics are C11 <stdatomic.h> where available, with the same
+ *      vendor fallback layer test.c uses for GCC and MSVC, so the
+ *      header compiles on toolchains without C11 atomics. Each side's
+ *      own variable is read with RELAXED loads: the owner is the only
+ *      writer of that variable, so only the peer's variable needs the
+ *      ACQUIRE.
+ */
+
+#include <stddef.h>
+
+// Atomics
+#if __STDC_VERSION__ >= 201112L && !__STDC_NO_ATOMICS
+#  include <stdatomic.h>
+#  define QUEUE_LOAD(p)      atomic_load_explicit(p, memory_order_acquire)
+#  define QUEUE_RLOAD(p)     atomic_load_explicit(p, memory_order_relaxed)
+#  define QUEUE_STORE(p, v)  atomic_store_explicit(p, v, memory_order_release)
+#elif __GNUC__
+#  define _Atomic
+#  define QUEUE_LOAD(p)      __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#  define QUEUE_RLOAD(p)     __atomic_load_n(p, __ATOMIC_RELAXED)
+#  define QUEUE_STORE(p, v)  __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#elif _MSC_VER
+#  define _Atomic volatile
+#  define QUEUE_LOAD(p)      *(p)      // MSC volatile has atomic semantics
+#  define QUEUE_RLOAD(p)     *(p)      //
+#  define QUEUE_STORE(p, v)  *(p) = v  // "
+#endif
+
+// Opt-in instrumentation: define QUEUE_STATS to count, per thread and
+// per translation unit, the events useful for sizing cap_lg2 from
+// data. The counters are thread-local plain increments, so the hot
+// path pays nothing shared; without the define everything compiles
+// away. Harvest from the owning thread with queue_stats_snapshot.
+#ifdef QUEUE_STATS
+#if __STDC_VERSION__ >= 201112L
+#  define QUEUE_TLS _Thread_local
+#elif __GNUC__
+#  define QUEUE_TLS __thread
+#elif _MSC_VER
+#  define QUEUE_TLS __declspec(thread)
+#endif
+typedef struct
+{
+    size_t empty_polls; // queue_pop found nothing poppable
+    size_t full_stalls; // queue_push found nothing pushable
+    size_t wraps;       // the pushable run reached the ring edge
+} QueueStats;
+static QUEUE_TLS QueueStats queue_stats;
+#define QUEUE_STATS_INC(f) (queue_stats.f += 1)
+/* Copies this thread's counters into [out] and restarts them. */
+static inline void queue_stats_snapshot(QueueStats *out)
+{
+    *out = queue_stats;
+    queue_stats = (QueueStats){0};
+}
+#else
+#define QUEUE_STATS_INC(f) ((void)0)
+#endif
+
+typedef struct { _Atomic size_t head, tail; } Queue;
+
+typedef struct
+{
+    size_t idx[2];
+    size_t cnt[2];
+    size_t len;
+} QueueSlice;
+
+/* Given the queue [q] of size 2^[cap_lg2], sets [*count] to the number
+ * of poppable elements and returns the index of the first one. */
+COMMON_INLINE size_t queue_pop(Queue *q, unsigned char cap_lg2, size_t *count)
+{
+    // This private copy of tail is essential to maintain a coherent
+    // value throughout the function, regardless of the consumer's
+    // actions.
+    // The ACQUIRE semantic is required because, without it, reads of
+    // the data could be reordered before the q->tail read.
+    // If that happens, a read might occur before the producer’s writes
+    // to the same elements become visible in memory, causing the consumer
+    // to read bytes that have not yet been produced.
+    size_t tail = QUEUE_LOAD(&q->tail);
+    size_t head = QUEUE_RLOAD(&q->head);
+    size_t mask = ((size_t)1 << cap_lg2) - 1;
+    // The cond variable is 0 iff tail is in the same (mask + 1)-sized block;
+    // otherwise, it is:
+    //   -- 1, if tail is in the next block and has not wrapped around SIZE_MAX,
+    //   -- a large odd negative number, if tail has wrapped around SIZE_MAX.
+    // The final bitwise AND reduces these cases to just (0, 1).
+    // We then use cond to conditionally subtract from the final value.
+    size_t cond = ((tail >> cap_lg2) - (head >> cap_lg2)) & 0x1;
+    *count = tail - head - (tail & mask) * cond;
+    if (!*count) QUEUE_STATS_INC(empty_polls);
+
+    return head & mask;
+}
+
+/* Commits the pop of [count] elements from queue [q]. */
+static inline void queue_commit_pop(Queue *q, size_t count)
+{
+    QUEUE_STORE(&q->head, QUEUE_RLOAD(&q->head) + count);
+}
+
+/* Given the queue [q] of size 2^[cap_lg2], sets [*count] to the number
+ * of pushable elements and returns the index of the first one. */
+COMMON_INLINE size_t queue_push(Queue *q, unsigned char cap_lg2, size_t *count)
+{
+    size_t head = QUEUE_LOAD(&q->head);
+    size_t tail = QUEUE_RLOAD(&q->tail);
+    size_t mask = ((size_t)1 << cap_lg2) - 1;
+    size_t cond = ((tail >> cap_lg2) - (head >> cap_lg2)) & 0x1;
+    *count = mask + 1 - (tail - head) - (head & mask) * (1 - cond);
+    if (!*count) QUEUE_STATS_INC(full_stalls);
+    if (*count && (tail & mask) + *count == mask + 1) QUEUE_STATS_INC(wraps);
+
+    return tail & mask;
+}
+
+/* Commits the push of [count] elements from queue [q]. */
+static inline void queue_commit_push(Queue *q, size_t count)
+{
+    QUEUE_STORE(&q->tail, QUEUE_RLOAD(&q->tail) + count);
+}
+
+/* Given the queue [q] of size 2^[cap_lg2], returns the whole free region
+ * as up to two {index, count} spans with a single acquire load of head.
+ * The producer fills some prefix of the spans, decrements cnt[0]/cnt[1]
+ * by the amounts filled, and passes the slice to queue_publish. */
+static inline QueueSlice queue_reserve(Queue *q, unsigned char cap_lg2)
+{
+    size_t head = QUEUE_LOAD(&q->head);
+    size_t tail = QUEUE_RLOAD(&q->tail);
+    size_t mask = ((size_t)1 << cap_lg2) - 1;
+    QueueSlice s = { .idx[0] = tail & mask,
+        .cnt[0] = mask + 1 - (tail - head) };
+    if (tail >> cap_lg2 == head >> cap_lg2)
+    {
+        s.cnt[0] -= head & mask;
+        s.cnt[1] = head & mask;
+    }
+    s.len = s.cnt[0] + s.cnt[1];
+
+    return s;
+}
+
+/* Publishes the elements written into the slice [s] of queue [q],
+ * i.e. the prefix of the reserved spans the producer consumed. */
+static inline void queue_publish(Queue *q, QueueSlice *s)
+{
+    size_t count = s->len - (s->cnt[0] + s->cnt[1]);
+    QUEUE_STORE(&q->tail, QUEUE_RLOAD(&q->tail) + count);
+}
+
+/* Relaxed occupancy estimate: how many elements are in queue [q], from
+ * two RELAXED loads. Either side may poll this (e.g. for emptiness or
+ * backpressure) without paying queue_pop's acquire fence, which is not
+ * free on weakly ordered machines. The estimate grants no permission
+ * to touch data: to actually read or write elements, go through
+ * queue_pop/queue_push, whose ACQUIRE makes the memory visible. */
+static inline size_t queue_peek_count(Queue *q)
+{
+    return QUEUE_RLOAD(&q->tail) - QUEUE_RLOAD(&q->head);
+}
+
+ 
+
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdatomic.h>
+
+#if ATOMIC_LLONG_LOCK_FREE == 2 || (ATOMIC_LONG_LOCK_FREE == 2 && ULONG_MAX == UINT64_MAX)
+#define BRDCT_MAX_CAPLG2 33
+#define BRDCT_RESIZE 0
+#define brdct_t uint_fast64_t
+#define atomic_brdct_t atomic_uint_fast64_t
+typedef uint32_t Reader;
+#else
+#define BRDCT_MAX_CAPLG2 17
+#define BRDCT_RESIZE 1
+#define brdct_t uint_fast32_t
+#define atomic_brdct_t atomic_uint_fast32_t
+typedef uint16_t Reader;
+#endif
+
+typedef union
+{
+    atomic_brdct_t raw;
+    struct
+    {
+        brdct_t tail      : (33  >> BRDCT_RESIZE) + BRDCT_RESIZE;
+        brdct_t nreaders  : 15  >> BRDCT_RESIZE;
+        brdct_t ncycled   : 15  >> BRDCT_RESIZE;
+        // hstate values (N is the size of the queue):
+        // - 0 if head and tail are in the same block of N/2 elements and
+        //      head is at the start of this block,
+        // - 1 if tail is in the next block and head is at the start of
+        //      the previous block.
+        brdct_t hstate    : 1;
+    };
+} Broadcast;
+
+typedef struct
+{
+    size_t idx[2];
+    size_t cnt[2];
+    size_t len;
+} Slice;
+
+// Under churn (dozens of readers attaching and committing at once) the
+// naked CAS retry loops below livelock-spiral: every loser reloads and
+// collides again on the next cycle. Each loop therefore backs off
+// between retries with randomized exponential pause escalating to a
+// thread yield, which spreads the retries out in time; the uncontended
+// path costs nothing, since the backoff state is a local that is never
+// touched when the first CAS lands. On LL/SC machines (ARM, RISC-V)
+// compare_exchange_strong wraps its own retry loop around the
+// exclusive pair, pure overhead inside a loop that recomputes anyway,
+// so those targets use the weak variant; BRDCT_CAS can be overridden.
+#ifndef BRDCT_CAS
+#if defined(__aarch64__) || defined(__arm__) || defined(__riscv)
+#define BRDCT_CAS atomic_compare_exchange_weak_explicit
+#else
+#define BRDCT_CAS atomic_compare_exchange_strong_explicit
+#endif
+#endif
+
+#ifndef BRDCT_BACKOFF_CAP_LG2
+#define BRDCT_BACKOFF_CAP_LG2 10
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sched.h>
+#define BRDCT_YIELD() sched_yield()
+#else
+#define BRDCT_YIELD() brdct_cpu_relax()
+#endif
+
+static inline void brdct_cpu_relax(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ __volatile__("yield");
+#endif
+}
+
+typedef struct { uint32_t shift, rng; } BrdctBackoff;
+
+/* One backoff step: pause a random number of cycles, doubling the
+ * range each retry up to 2^BRDCT_BACKOFF_CAP_LG2, then yield the
+ * thread instead. Zero-initialize the state per CAS loop; the first
+ * step seeds the LCG from the state's stack address, so contending
+ * threads draw different sequences and do not re-collide in lockstep. */
+static inline void brdct_backoff(BrdctBackoff *b)
+{
+    if (b->shift >= BRDCT_BACKOFF_CAP_LG2)
+    {
+        BRDCT_YIELD();
+        return;
+    }
+    if (!b->rng)
+        b->rng = (uint32_t)((uintptr_t)b >> 4) * 2654435761u | 1u;
+    b->shift += 1;
+    b->rng = b->rng * 1664525u + 1013904223u;
+    for (uint32_t spins = b->rng >> (32 - b->shift); spins; spins--)
+        brdct_cpu_relax();
+}
+
+// Opt-in instrumentation: define BRDCT_STATS to count, per thread and
+// per translation unit, how often each CAS loop retries. The counters
+// are thread-local plain increments — nothing shared on the hot path —
+// and everything compiles away without the define. Harvest from the
+// owning thread with brdct_cas_stats_snapshot; the retry distribution
+// across deployments is the signal for sizing caplg2.
+#ifdef BRDCT_STATS
+typedef struct
+{
+    size_t attach_retries;
+    size_t detach_retries;
+    size_t reader_commit_retries;
+    size_t writer_slice_retries;
+    size_t writer_commit_retries;
+} BrdctCasStats;
+static _Thread_local BrdctCasStats brdct_cas_stats;
+#define BRDCT_STATS_RETRY(f) (brdct_cas_stats.f += 1)
+/* Copies this thread's counters into [out] and restarts them. */
+static inline void brdct_cas_stats_snapshot(BrdctCasStats *out)
+{
+    *out = brdct_cas_stats;
+    brdct_cas_stats = (BrdctCasStats){0};
+}
+#else
+#define BRDCT_STATS_RETRY(f) ((void)0)
+#endif
+
+static inline int brdct_attach_reader(Broadcast *brc, unsigned char caplg2, Reader *r)
+{
+    Broadcast curr, new;
+    BrdctBackoff bo = {0, 0};
+    curr.raw = atomic_load_explicit(&brc->raw, memory_order_relaxed);
+    do
+    {
+        if (curr.nreaders == ((1 << 15) - 1) >> BRDCT_RESIZE) return -1;
+        new = curr;
+        new.nreaders += 1;
+    } while (COMMON_UNLIKELY(!BRDCT_CAS(&brc->raw, &curr.raw,
+        new.raw, memory_order_acq_rel, memory_order_relaxed)
+        && (BRDCT_STATS_RETRY(attach_retries), brdct_backoff(&bo), 1)));
+    
+    brdct_t halflen = (brdct_t)1 << (caplg2 - 1);
+    *r = (new.tail & -halflen) - halflen * new.hstate;
+    
+    return 0;
+}
+
+static inline void brdct_detach_reader(Broadcast *brc, unsigned char caplg2, Reader *r)
+{
+    Broadcast curr, new;
+    BrdctBackoff bo = {0, 0};
+    curr.raw = atomic_load_explicit(&brc->raw, memory_order_relaxed);
+    do
+    {
+        new = curr;
+        new.nreaders -= 1;
+        if (new.hstate && new.tail >> (caplg2 - 1) == *r >> (caplg2 - 1))
+            new.ncycled -= 1;
+    } while (COMMON_UNLIKELY(!BRDCT_CAS(&brc->raw, &curr.raw,
+        new.raw, memory_order_acq_rel, memory_order_relaxed)
+        && (BRDCT_STATS_RETRY(detach_retries), brdct_backoff(&bo), 1)));
+}
+
+COMMON_INLINE Slice brdct_reader_slice(Broadcast *brc, unsigned char caplg2, Reader *r)
+{
+    Broadcast curr;
+    curr.raw = atomic_load_explicit(&brc->raw, memory_order_acquire);
+    brdct_t mask = ((brdct_t)1 << caplg2) - 1;
+    Slice s = { .idx[0] = *r & mask, .cnt[0] = curr.tail - *r };
+    if (curr.tail >> caplg2 != *r >> caplg2)
+    {
+        s.cnt[0] -= curr.tail & mask;
+        s.cnt[1] = curr.tail & mask;
+    }
+    s.len = s.cnt[0] + s.cnt[1];
+    
+    return s;
+}
+
+static inline void brdct_reader_commit(Broadcast *brc, unsigned char caplg2, Reader *r, Slice *s)
+{
+    size_t count = s->len - (s->cnt[0] + s->cnt[1]);
+    Reader prev = *r;
+    *r += count;
+    if (*r >> (caplg2 - 1) == prev >> (caplg2 - 1)) return;
+    
+    Broadcast curr, new;
+    BrdctBackoff bo = {0, 0};
+    curr.raw = atomic_load_explicit(&brc->raw, memory_order_relaxed);
+    do
+    {
+        new = curr;
+        new.ncycled += 1;
+    } while (COMMON_UNLIKELY(!BRDCT_CAS(&brc->raw, &curr.raw,
+        new.raw, memory_order_acq_rel, memory_order_relaxed)
+        && (BRDCT_STATS_RETRY(reader_commit_retries), brdct_backoff(&bo), 1)));
+}
+
+COMMON_INLINE Slice brdct_writer_slice(Broadcast *brc, unsigned char caplg2)
+{
+    Broadcast curr, new;
+    BrdctBackoff bo = {0, 0};
+    curr.raw = atomic_load_explicit(&brc->raw, memory_order_acquire);
+    do
+    {
+        new = curr;
+        if (new.nreaders == 0 || new.ncycled < new.nreaders) break;
+        new.ncycled = 0;
+        new.hstate = 0;
+    } while (COMMON_UNLIKELY(!BRDCT_CAS(&brc->raw, &curr.raw,
+        new.raw, memory_order_acq_rel, memory_order_relaxed)
+        && (BRDCT_STATS_RETRY(writer_slice_retries), brdct_backoff(&bo), 1)));
+    
+    brdct_t halflen = (brdct_t)1 << (caplg2 - 1);
+    brdct_t head = (new.tail & -halflen) - halflen * new.hstate;
+    brdct_t mask = ((brdct_t)1 << caplg2) - 1;
+    Slice s = { .idx[0] = new.tail & mask,
+        .cnt[0] = mask + 1 - (new.tail - head) };
+    if (new.tail >> caplg2 == head >> caplg2)
+    {
+        s.cnt[0] -= head & mask;
+        s.cnt[1] = head & mask;
+    }
+    s.len = s.cnt[0] + s.cnt[1];
+    
+    // Blocks productions that would lead to a full queue.
+    if (new.tail + s.len - head == (brdct_t)1 << caplg2)
+    {
+        s.len -= 1;
+        if (s.cnt[1] > 0) s.cnt[1] -= 1;
+        else if (s.cnt[0] > 0) s.cnt[0] -= 1;
+    }
+
+    return s;
+}
+
+static inline void brdct_writer_commit(Broadcast *brc, unsigned char caplg2, Slice *s)
+{
+    size_t count = s->len - (s->cnt[0] + s->cnt[1]);
+    Broadcast curr, new;
+    BrdctBackoff bo = {0, 0};
+    curr.raw = atomic_load_explicit(&brc->raw, memory_order_relaxed);
+    do
+    {
+        new = curr;
+        new.tail += count;
+        if (new.tail >> (caplg2 - 1) != curr.tail >> (caplg2 - 1))
+            new.hstate = 1;
+    } while (COMMON_UNLIKELY(!BRDCT_CAS(&brc->raw, &curr.raw,
+        new.raw, memory_order_acq_rel, memory_order_relaxed)
+        && (BRDCT_STATS_RETRY(writer_commit_retries), brdct_backoff(&bo), 1)));
+}
+
+/* Returns how many elements the cursor [r] is behind the writer. One
+ * relaxed load of the packed word. The cursor is the reader-private
+ * value, taken by value so a monitoring thread can be handed a
+ * snapshot: have each reader publish its own cursor (an atomic, a
+ * mailbox) and feed the samples here — reading another thread's live
+ * Reader directly would be a data race. */
+static inline size_t brdct_reader_lag(Broadcast *brc, Reader r)
+{
+    Broadcast curr;
+    curr.raw = atomic_load_explicit(&brc->raw, memory_order_relaxed);
+    return (size_t)(curr.tail - r);
+}
+
+/* Returns the number of elements the slowest reader has not consumed
+ * (the writer's view of ring occupancy), from one relaxed load.
+ * Derived from the same head reconstruction brdct_writer_slice uses:
+ * head = (tail & -halflen) - halflen * hstate. */
+static inline size_t brdct_occupancy(Broadcast *brc, unsigned char caplg2)
+{
+    Broadcast curr;
+    curr.raw = atomic_load_explicit(&brc->raw, memory_order_relaxed);
+    brdct_t halflen = (brdct_t)1 << (caplg2 - 1);
+    return (size_t)((curr.tail & (halflen - 1)) + halflen * curr.hstate);
+}
+
+typedef struct
+{
+    atomic_size_t hwm;        // highest occupancy sampled so far
+    atomic_size_t halfcycles; // half-blocks the writer has crossed
+    size_t last_tail;         // writer-private progress marker
+} BrdctStats;
+
+/* Writer-side: folds the current occupancy and tail progress of [brc]
+ * into [st]. Call it from the publish loop at whatever period suits;
+ * the stores are relaxed, so the monitoring thread pairs them with
+ * relaxed loads of hwm/halfcycles and the hot path pays no fence. */
+static inline void brdct_stats_sample(BrdctStats *st, Broadcast *brc,
+                               unsigned char caplg2)
+{
+    Broadcast curr;
+    curr.raw = atomic_load_explicit(&brc->raw, memory_order_relaxed);
+    size_t occ = brdct_occupancy(brc, caplg2);
+    if (occ > atomic_load_explicit(&st->hwm, memory_order_relaxed))
+        atomic_store_explicit(&st->hwm, occ, memory_order_relaxed);
+    size_t crossed = (size_t)((curr.tail >> (caplg2 - 1)) -
+        (st->last_tail >> (caplg2 - 1)));
+    if (crossed)
+    {
+        atomic_store_explicit(&st->halfcycles,
+            atomic_load_explicit(&st->halfcycles, memory_order_relaxed)
+                + crossed, memory_order_relaxed);
+        st->last_tail = (size_t)curr.tail;
+    }
+}
+
+#undef brdct_t
+#undef atomic_brdct_t
+#undef BRDCT_RESIZE
+
+#endif // COMMON_H
@@ -0,0 +1,306 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RING_HPP
+#define RING_HPP
+
+/* C++17 compile-time-capacity counterparts of queue.h and
+ * broadcast_mr.h. The C headers take cap_lg2 as a runtime value, so
+ * the mask is re-derived per call and never constant-folds; they also
+ * cannot be included from C++ (designated array initializers, C11
+ * <stdatomic.h>). These templates carry the same algorithms with the
+ * capacity baked in as constexpr, own a typed slot array, and return
+ * pointer+length spans instead of indices. Some notable facts:
+ *
+ * 1: SpscQueue is the queue.h algorithm with the padded layout of
+ *      padded_queue.h: head and tail on separate cache lines, each
+ *      next to a shadow of the remote index that is refreshed only on
+ *      the empty/full edge.
+ * 2: BroadcastRing is the per-reader-cursor algorithm of
+ *      broadcast_mr.h: commits are plain release stores to the
+ *      reader's own line and the writer recomputes the minimum cursor
+ *      lazily.
+ * 3: Regions are returned as up to two {pointer, length} spans, the
+ *      typed equivalent of the two-span Slice. With CapLg2 a template
+ *      argument, the mask math constant-folds and drain loops over the
+ *      spans autovectorize.
+ * 4: T must be default-constructible, since the ring owns the slot
+ *      array. Bulk typed transfer helpers live in the same classes so
+ *      trivially-copyable element loops can collapse to memcpy.
+ */
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <type_traits>
+#include <utility>
+
+namespace rings
+{
+
+#ifndef RING_CACHELINE
+#define RING_CACHELINE 64
+#endif
+
+template <typename T>
+struct Span
+{
+    T *ptr;
+    std::size_t len;
+};
+
+template <typename T>
+struct Spans
+{
+    Span<T> s[2];
+    std::size_t len;
+};
+
+template <typename T, unsigned CapLg2>
+class SpscQueue
+{
+public:
+    static constexpr std::size_t capacity = std::size_t(1) << CapLg2;
+    static constexpr std::size_t mask = capacity - 1;
+
+    /* Returns the free region as up to two typed spans, touching the
+     * consumer's line only when the cached head runs dry. */
+    Spans<T> push_spans()
+    {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ == capacity)
+            head_cache_ = head_.load(std::memory_order_acquire);
+        std::size_t space = capacity - (tail - head_cache_);
+        return spans(tail, space);
+    }
+
+    /* Publishes the first [n] slots of the last push_spans result. */
+    void publish(std::size_t n)
+    {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        tail_.store(tail + n, std::memory_order_release);
+    }
+
+    /* Returns the readable region as up to two typed spans, touching
+     * the producer's line only when the cached tail runs dry. */
+    Spans<T> pop_spans()
+    {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        if (tail_cache_ == head)
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+        return spans(head, tail_cache_ - head);
+    }
+
+    /* Releases the first [n] slots of the last pop_spans result. */
+    void release(std::size_t n)
+    {
+        std::size_t head = head_.load(std::memory_order_relaxed);
+        head_.store(head + n, std::memory_order_release);
+    }
+
+    /* Single-element conveniences over the span API. */
+    bool try_push(const T &v)
+    {
+        Spans<T> sp = push_spans();
+        if (sp.len == 0) return false;
+        *sp.s[0].ptr = v;
+        publish(1);
+        return true;
+    }
+
+    bool try_pop(T &v)
+    {
+        Spans<T> sp = pop_spans();
+        if (sp.len == 0) return false;
+        v = *sp.s[0].ptr;
+        release(1);
+        return true;
+    }
+
+    /* Moves up to [n] elements from [src] into the ring and publishes
+     * them. Trivially-copyable T collapses to one memcpy per span;
+     * anything else is move-assigned element-wise. Handles the wrap
+     * split internally; returns the number of elements pushed. */
+    std::size_t emplace_bulk(T *src, std::size_t n)
+    {
+        Spans<T> sp = push_spans();
+        std::size_t total = n < sp.len ? n : sp.len;
+        std::size_t left = total;
+        for (int i = 0; i < 2 && left; i++)
+        {
+            std::size_t c = left < sp.s[i].len ? left : sp.s[i].len;
+            transfer(sp.s[i].ptr, src, c);
+            src += c;
+            left -= c;
+        }
+        publish(total);
+        return total;
+    }
+
+    /* Moves up to [n] elements out of the ring into [dst] and releases
+     * them. Same fast path and wrap handling as emplace_bulk; returns
+     * the number of elements popped. */
+    std::size_t consume_bulk(T *dst, std::size_t n)
+    {
+        Spans<T> sp = pop_spans();
+        std::size_t total = n < sp.len ? n : sp.len;
+        std::size_t left = total;
+        for (int i = 0; i < 2 && left; i++)
+        {
+            std::size_t c = left < sp.s[i].len ? left : sp.s[i].len;
+            transfer(dst, sp.s[i].ptr, c);
+            dst += c;
+            left -= c;
+        }
+        release(total);
+        return total;
+    }
+
+private:
+    static void transfer(T *dst, T *src, std::size_t n)
+    {
+        if constexpr (std::is_trivially_copyable_v<T>)
+            std::memcpy(dst, src, n * sizeof(T));
+        else
+            for (std::size_t k = 0; k < n; k++)
+                dst[k] = std::move(src[k]);
+    }
+
+    Spans<T> spans(std::size_t from, std::size_t n)
+    {
+        std::size_t i = from & mask;
+        std::size_t first = capacity - i < n ? capacity - i : n;
+        return { { { slots_ + i, first }, { slots_, n - first } }, n };
+    }
+
+    alignas(RING_CACHELINE) std::atomic<std::size_t> head_{0};
+    std::size_t tail_cache_{0};
+    alignas(RING_CACHELINE) std::atomic<std::size_t> tail_{0};
+    std::size_t head_cache_{0};
+    alignas(RING_CACHELINE) T slots_[capacity];
+};
+
+template <typename T, unsigned CapLg2, unsigned MaxReaders = 64>
+class BroadcastRing
+{
+public:
+    static constexpr std::size_t capacity = std::size_t(1) << CapLg2;
+    static constexpr std::size_t mask = capacity - 1;
+
+    /* Attaches a reader starting at the current tail. Returns the slot
+     * handle, or -1 if all MaxReaders slots are taken. */
+    int attach()
+    {
+        for (unsigned i = 0; i < MaxReaders; i++)
+        {
+            std::size_t expect = 0;
+            if (!slot_[i].active.compare_exchange_strong(expect, 1,
+                    std::memory_order_acquire, std::memory_order_relaxed))
+                continue;
+            slot_[i].cursor.store(tail_.load(std::memory_order_acquire),
+                std::memory_order_release);
+            return (int)i;
+        }
+        return -1;
+    }
+
+    void detach(int r)
+    {
+        slot_[r].active.store(0, std::memory_order_release);
+    }
+
+    /* Returns the published, unconsumed region of reader [r]. */
+    Spans<const T> read_spans(int r)
+    {
+        std::size_t tail = tail_.load(std::memory_order_acquire);
+        std::size_t cur = slot_[r].cursor.load(std::memory_order_relaxed);
+        return spans<const T>(cur, tail - cur);
+    }
+
+    /* Consumes the first [n] elements of the last read_spans result:
+     * one release store to the reader's own cache line. */
+    void read_release(int r, std::size_t n)
+    {
+        std::size_t cur = slot_[r].cursor.load(std::memory_order_relaxed);
+        slot_[r].cursor.store(cur + n, std::memory_order_release);
+    }
+
+    /* Returns the writable region, bounded by the slowest active
+     * reader; the cached minimum is refreshed only when exhausted. */
+    Spans<T> write_spans()
+    {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        if (capacity - (tail - head_cache_) <= 1)
+            head_cache_ = min_cursor(tail);
+        std::size_t space = capacity - (tail - head_cache_);
+        // Blocks productions that would lead to a full queue.
+        return spans<T>(tail, space ? space - 1 : 0);
+    }
+
+    /* Publishes the first [n] slots of the last write_spans result. */
+    void write_publish(std::size_t n)
+    {
+        std::size_t tail = tail_.load(std::memory_order_relaxed);
+        tail_.store(tail + n, std::memory_order_release);
+    }
+
+private:
+    template <typename U>
+    Spans<U> spans(std::size_t from, std::size_t n)
+    {
+        std::size_t i = from & mask;
+        std::size_t first = capacity - i < n ? capacity - i : n;
+        return { { { slots_ + i, first }, { slots_, n - first } }, n };
+    }
+
+    std::size_t min_cursor(std::size_t tail)
+    {
+        std::size_t min = tail;
+        for (unsigned i = 0; i < MaxReaders; i++)
+        {
+            if (!slot_[i].active.load(std::memory_order_acquire)) continue;
+            std::size_t c = slot_[i].cursor.load(std::memory_order_acquire);
+            // Discards the stale cursor of an attach in flight; the
+            // real cursor is at tail (see broadcast_mr.h point 4).
+            if (tail - c > capacity) continue;
+            if (tail - c > tail - min) min = c;
+        }
+        return min;
+    }
+
+    struct alignas(RING_CACHELINE) Slot
+    {
+        std::atomic<std::size_t> cursor{0};
+        std::atomic<std::size_t> active{0};
+    };
+
+    Slot slot_[MaxReaders];
+    alignas(RING_CACHELINE) std::atomic<std::size_t> tail_{0};
+    std::size_t head_cache_{0};
+    alignas(RING_CACHELINE) T slots_[capacity];
+};
+
+} // namespace rings
+
+#endif
@@ -0,0 +1,200 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef RING_AWAIT_HPP
+#define RING_AWAIT_HPP
+
+/* C++20 awaitable adapters for ring.hpp: a would-block pop or read
+ * parks the coroutine handle in a slot the committer resumes, so one
+ * thread multiplexes many rings with no poller. Some notable facts:
+ *
+ * 1: The parked slot is an atomic handle address and ownership is
+ *      settled by exchange: whoever swaps the handle out (the
+ *      committer to resume it, or the parker reclaiming it after a
+ *      racing commit) is the one side that resumes, so a handle is
+ *      never resumed twice.
+ * 2: The park/commit race is the same store-load problem as the futex
+ *      layers (queue_wait.h point 3), but a coroutine has no timeout
+ *      backstop: a lost resume is a hang, not a latency blip. So this
+ *      file pays for correctness with a pair of seq_cst fences — the
+ *      parker fences between publishing its handle and rechecking the
+ *      ring, the committer between publishing data and checking the
+ *      slot. The committer's empty fast path is thus one fence plus
+ *      one relaxed load: no syscall, no RMW, but not the literal lone
+ *      relaxed load, which cannot be made hang-free without a timer.
+ * 3: After the parker publishes its handle it touches only locals: the
+ *      committer may legally resume (and finish, and free) the frame
+ *      before await_suspend returns, so the awaiter object itself is
+ *      off limits from that point.
+ * 4: The committer resumes inline, on its own thread. A resumed
+ *      consumer that does heavy work before re-awaiting stalls the
+ *      producer for that long; reschedule onto an executor inside the
+ *      coroutine if that matters.
+ */
+
+#include <atomic>
+#include <coroutine>
+#include "ring.hpp"
+
+namespace rings
+{
+
+template <typename T, unsigned CapLg2>
+class AwaitSpscQueue
+{
+public:
+    /* Awaitable pop: resumes with a nonempty Spans as soon as the
+     * producer publishes. Single consumer, like the ring below. */
+    auto pop_spans()
+    {
+        struct Awaiter
+        {
+            AwaitSpscQueue *aq;
+            Spans<T> sp{};
+
+            bool await_ready() noexcept
+            {
+                sp = aq->q_.pop_spans();
+                return sp.len != 0;
+            }
+
+            bool await_suspend(std::coroutine_handle<> h) noexcept
+            {
+                AwaitSpscQueue *q = aq; // locals only past the store
+                q->waiter_.store(h.address(), std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (q->q_.pop_spans().len == 0) return true;
+                // data raced in: reclaim the handle unless the
+                // producer already took it (then it resumes us)
+                return q->waiter_.exchange(nullptr,
+                    std::memory_order_acq_rel) == nullptr;
+            }
+
+            Spans<T> await_resume() noexcept
+            {
+                if (sp.len == 0) sp = aq->q_.pop_spans();
+                return sp;
+            }
+        };
+        return Awaiter{this};
+    }
+
+    void release(std::size_t n) { q_.release(n); }
+
+    Spans<T> push_spans() { return q_.push_spans(); }
+
+    /* Publishes [n] slots and resumes the parked consumer, if any.
+     * Empty fast path: one seq_cst fence plus one relaxed load. */
+    void publish(std::size_t n)
+    {
+        q_.publish(n);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        void *w = waiter_.load(std::memory_order_relaxed);
+        if (w && (w = waiter_.exchange(nullptr, std::memory_order_acq_rel)))
+            std::coroutine_handle<>::from_address(w).resume();
+    }
+
+private:
+    SpscQueue<T, CapLg2> q_;
+    std::atomic<void *> waiter_{nullptr};
+};
+
+template <typename T, unsigned CapLg2, unsigned MaxReaders = 64>
+class AwaitBroadcastRing
+{
+public:
+    int attach() { return b_.attach(); }
+    void detach(int r) { b_.detach(r); }
+    void read_release(int r, std::size_t n) { b_.read_release(r, n); }
+    Spans<T> write_spans() { return b_.write_spans(); }
+
+    /* Awaitable read for reader [r]: resumes with a nonempty Spans as
+     * soon as the writer publishes past the reader's cursor. */
+    auto next_slice(int r)
+    {
+        struct Awaiter
+        {
+            AwaitBroadcastRing *ab;
+            int r;
+            Spans<const T> sp{};
+
+            bool await_ready() noexcept
+            {
+                sp = ab->b_.read_spans(r);
+                return sp.len != 0;
+            }
+
+            bool await_suspend(std::coroutine_handle<> h) noexcept
+            {
+                AwaitBroadcastRing *b = ab;
+                int slot = r; // locals only past the store
+                b->waiter_[slot].store(h.address(),
+                    std::memory_order_seq_cst);
+                b->parked_.fetch_add(1, std::memory_order_seq_cst);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (b->b_.read_spans(slot).len == 0) return true;
+                if (b->waiter_[slot].exchange(nullptr,
+                        std::memory_order_acq_rel) == nullptr)
+                    return true; // the writer took it and resumes us
+                b->parked_.fetch_sub(1, std::memory_order_relaxed);
+                return false;
+            }
+
+            Spans<const T> await_resume() noexcept
+            {
+                if (sp.len == 0) sp = ab->b_.read_spans(r);
+                return sp;
+            }
+        };
+        return Awaiter{this, r};
+    }
+
+    /* Publishes [n] slots and resumes every parked reader. With nobody
+     * parked: one seq_cst fence plus one relaxed load. */
+    void write_publish(std::size_t n)
+    {
+        b_.write_publish(n);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked_.load(std::memory_order_relaxed) == 0) return;
+        for (unsigned i = 0; i < MaxReaders; i++)
+        {
+            void *w = waiter_[i].load(std::memory_order_relaxed);
+            if (w && (w = waiter_[i].exchange(nullptr,
+                    std::memory_order_acq_rel)))
+            {
+                parked_.fetch_sub(1, std::memory_order_relaxed);
+                std::coroutine_handle<>::from_address(w).resume();
+            }
+        }
+    }
+
+private:
+    BroadcastRing<T, CapLg2, MaxReaders> b_;
+    std::atomic<void *> waiter_[MaxReaders]{};
+    std::atomic<unsigned> parked_{0};
+};
+
+} // namespace rings
+
+#endif
@@ -0,0 +1,129 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MIRROR_H
+#define MIRROR_H
+
+/* A double-mapped ("magic ring") buffer allocator.
+ * The two-element idx/cnt arrays of the broadcast Slice and the
+ * QueueSlice exist only because a ring region can straddle the wrap
+ * point. Mapping the same physical pages twice, back to back, makes
+ * the wrap disappear: byte [i] and byte [i + size] are the same byte,
+ * so any region of up to [size] bytes is contiguous through the seam.
+ * Some notable facts:
+ *
+ * 1: Nothing in queue.h or broadcast.h changes. Back the ring with
+ *      mirror_map instead of a plain array and collapse any slice to a
+ *      single span: the region starts at base + idx[0] * esize and runs
+ *      for len elements, because the second span (which always has
+ *      idx[1] == 0) is reachable as the mirror pages right after the
+ *      first copy. memcpy, SIMD scans and parsers can run straight
+ *      across the former wrap boundary.
+ * 2: For the same reason, the clamp-to-wrap counts of queue_pop and
+ *      queue_push may be ignored in favor of the full occupancy/space:
+ *      with a mirrored buffer the clamped and unclamped regions are
+ *      both contiguous.
+ * 3: [size] must be a multiple of the page size; together with the
+ *      power-of-2 capacity the rings already require, that means a
+ *      capacity of at least one page.
+ * 4: The implementation reserves 2 * size of address space, creates an
+ *      anonymous shared file (memfd_create on Linux, shm_open
+ *      elsewhere) and maps it twice over the reservation with
+ *      MAP_FIXED. The fd is closed before returning; the mappings keep
+ *      the pages alive. Windows needs VirtualAlloc2/MapViewOfFile3 and
+ *      is not covered here.
+ * 5: The aliasing is invisible to the compiler: it may assume that
+ *      base[i] and base[size + i] are distinct bytes and cache values
+ *      across a write to the twin address. This cannot happen in the
+ *      intended use — the reader observes data the writer published
+ *      through an acquire load of head/tail, which is already a
+ *      compiler barrier — but single-threaded code that writes through
+ *      one copy and immediately reads through the other at offsets the
+ *      optimizer can see must insert a barrier itself.
+ */
+
+#include <stddef.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <stdio.h>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+
+static int mirror_open_fd(size_t size)
+{
+    int fd = (int)syscall(SYS_memfd_create, "mirror", 0);
+    if (fd < 0) return -1;
+    if (ftruncate(fd, (off_t)size) < 0) { close(fd); return -1; }
+    return fd;
+}
+
+#else
+
+static int mirror_open_fd(size_t size)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "/mirror_%ld_%p", (long)getpid(),
+        (void *)&name);
+    int fd = shm_open(name, O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) return -1;
+    shm_unlink(name);
+    if (ftruncate(fd, (off_t)size) < 0) { close(fd); return -1; }
+    return fd;
+}
+
+#endif
+
+/* Maps a ring of [size] bytes (multiple of the page size) twice back
+ * to back. Returns the base of the first copy, or NULL on failure. */
+static void *mirror_map(size_t size)
+{
+    void *base = mmap(0, 2 * size, PROT_NONE,
+        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (base == MAP_FAILED) return 0;
+
+    int fd = mirror_open_fd(size);
+    if (fd < 0) { munmap(base, 2 * size); return 0; }
+
+    void *lo = mmap(base, size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_FIXED, fd, 0);
+    void *hi = mmap((char *)base + size, size, PROT_READ | PROT_WRITE,
+        MAP_SHARED | MAP_FIXED, fd, 0);
+    close(fd);
+    if (lo == MAP_FAILED || hi == MAP_FAILED)
+    {
+        munmap(base, 2 * size);
+        return 0;
+    }
+    return base;
+}
+
+/* Unmaps a buffer of [size] bytes obtained from mirror_map. */
+static void mirror_unmap(void *base, size_t size)
+{
+    munmap(base, 2 * size);
+}
+
+#endif
@@ -0,0 +1,171 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MLQ_QUEUE_H
+#define MLQ_QUEUE_H
+
+/* A multi-lane queue: N queue.h rings under one summary bitmask, for
+ * latency-class separation (a cancel lane overtaking a bulk lane).
+ * Polling N rings costs N acquire loads per poll even when all are
+ * empty; here the common case is one relaxed load of the summary.
+ * Some notable facts:
+ *
+ * 1: Bit l of the summary is set when lane l may be nonempty. It is a
+ *      conservative superset: the producer sets it after committing (so
+ *      a set bit may be seen before the data — queue_pop's acquire
+ *      still decides what is readable) and the consumer lazily clears
+ *      it when a pop finds the lane empty. After clearing, the
+ *      consumer rechecks the lane and re-sets the bit if a push raced
+ *      in between, so a nonempty lane is never left unsummarized.
+ * 2: Lower lane index means higher priority; mlq_pop serves the lowest
+ *      set bit (one ctz). All lanes share one cap_lg2 and each lane
+ *      remains SPSC: one producer and one consumer overall, or one
+ *      producer per lane and a single consumer — the summary word is
+ *      the only state touched by more than two threads, and only with
+ *      or/and.
+ * 3: Strict priority starves low lanes under high-lane load, which is
+ *      right for gateways. For loggers, mlq_pop_drr rotates lanes with
+ *      a deficit counter (deficit round robin): each visit grants the
+ *      lane a quantum of elements, unspent grant carries over, and an
+ *      empty lane forfeits it. The DRR state is consumer-private, so
+ *      it needs no atomics.
+ */
+
+#include <stdint.h>
+#include "queue.h"
+
+#define MLQ_MAX_LANES 32
+
+typedef struct
+{
+    Queue lane[MLQ_MAX_LANES];
+    uint32_t summary;
+} Mlq;
+
+/* As queue_push, on lane [l]. */
+static inline size_t mlq_push(Mlq *m, unsigned l, unsigned char cap_lg2,
+                              size_t *count)
+{
+    return queue_push(&m->lane[l], cap_lg2, count);
+}
+
+/* Commits [count] elements to lane [l] and flags it in the summary. */
+static inline void mlq_commit_push(Mlq *m, unsigned l, size_t count)
+{
+    queue_commit_push(&m->lane[l], count);
+    __atomic_fetch_or(&m->summary, (uint32_t)1 << l, __ATOMIC_RELEASE);
+}
+
+/* Pops from the highest-priority nonempty lane: sets [*l] and [*count]
+ * and returns the index of the first element, or sets [*count] to 0 if
+ * every lane is empty. One relaxed summary load in the common case. */
+static size_t mlq_pop(Mlq *m, unsigned char cap_lg2, unsigned *l,
+                      size_t *count)
+{
+    for (;;)
+    {
+        uint32_t sum = __atomic_load_n(&m->summary, __ATOMIC_RELAXED);
+        if (!sum)
+        {
+            *count = 0;
+            return 0;
+        }
+        unsigned lane = (unsigned)__builtin_ctz(sum);
+        size_t idx = queue_pop(&m->lane[lane], cap_lg2, count);
+        if (!*count)
+        {
+            // stale bit: clear, recheck, undo the clear if a push raced.
+            // ACQUIRE: the fetch_and reads from the producer's release
+            // fetch_or, so the recheck is guaranteed to see any commit
+            // that preceded the clear — otherwise we could wipe the bit
+            // of a nonempty lane
+            __atomic_fetch_and(&m->summary, ~((uint32_t)1 << lane),
+                __ATOMIC_ACQUIRE);
+            idx = queue_pop(&m->lane[lane], cap_lg2, count);
+            if (!*count) continue;
+            __atomic_fetch_or(&m->summary, (uint32_t)1 << lane,
+                __ATOMIC_RELAXED);
+        }
+        *l = lane;
+        return idx;
+    }
+}
+
+/* Commits the pop of [count] elements from lane [l]. The summary bit
+ * stays set until a later mlq_pop finds the lane empty. */
+static inline void mlq_commit_pop(Mlq *m, unsigned l, size_t count)
+{
+    queue_commit_pop(&m->lane[l], count);
+}
+
+// Consumer-private deficit-round-robin state.
+typedef struct
+{
+    unsigned next;
+    size_t deficit[MLQ_MAX_LANES];
+} MlqDrr;
+
+/* As mlq_pop, but rotates fairly over [nlanes] lanes: the served count
+ * is capped at the lane's accumulated deficit (one [quantum] granted
+ * per visit), and an empty lane forfeits its grant. Commit with
+ * mlq_commit_pop_drr so the deficit is spent. */
+static size_t mlq_pop_drr(Mlq *m, unsigned nlanes, unsigned char cap_lg2,
+                          size_t quantum, MlqDrr *d, unsigned *l,
+                          size_t *count)
+{
+    if (!__atomic_load_n(&m->summary, __ATOMIC_RELAXED))
+    {
+        *count = 0;
+        return 0;
+    }
+    for (unsigned i = 0; i < nlanes; i++)
+    {
+        unsigned lane = d->next;
+        size_t idx = queue_pop(&m->lane[lane], cap_lg2, count);
+        if (!*count)
+        {
+            d->deficit[lane] = 0; // empty lanes forfeit their grant
+            d->next = (lane + 1) % nlanes;
+            continue;
+        }
+        d->deficit[lane] += quantum;
+        if (*count > d->deficit[lane]) *count = d->deficit[lane];
+        *l = lane;
+        return idx;
+    }
+    *count = 0;
+    return 0;
+}
+
+/* Commits the DRR pop of [count] elements from lane [l], spending its
+ * deficit and rotating to the next lane once the grant is used up. */
+static inline void mlq_commit_pop_drr(Mlq *m, unsigned nlanes, MlqDrr *d,
+                                      unsigned l, size_t count)
+{
+    queue_commit_pop(&m->lane[l], count);
+    d->deficit[l] -= count;
+    if (d->deficit[l] == 0) d->next = (l + 1) % nlanes;
+}
+
+#endif
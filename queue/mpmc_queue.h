@@ -0,0 +1,130 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef MPMC_QUEUE_H
+#define MPMC_QUEUE_H
+
+/* A multi-producer/multi-consumer sibling of queue.h.
+ * It keeps the same index-returning, type-agnostic style: the queue state
+ * never touches the user's data array, so any element type works. The MPMC
+ * extension is based on per-slot sequence numbers (a ticket scheme), not on
+ * a CAS loop over head/tail. Some notable facts:
+ *
+ * 1: queue.h works in SPSC because each side owns exactly one variable.
+ *      With multiple producers, two threads would race on tail, and a
+ *      CAS loop on tail serializes them with retries. Here a producer
+ *      claims its slot with a single fetch-add on tail instead: the
+ *      returned ticket is unique, so claiming never fails and never
+ *      retries, no matter how many producers run concurrently.
+ * 2: A ticket alone is not enough: the claimed slot may still hold data
+ *      from the previous lap that a consumer has not drained yet. A
+ *      per-slot sequence word arbitrates this. For a queue of capacity
+ *      N = 2^cap_lg2, slot [i] starts at seq[i] == i and the protocol is:
+ *      - producer with ticket t waits until seq[t & mask] == t,
+ *        writes the element, then stores seq[t & mask] = t + 1;
+ *      - consumer with ticket t waits until seq[t & mask] == t + 1,
+ *        reads the element, then stores seq[t & mask] = t + N.
+ *      After a full lap the slot value is exactly the next producer's
+ *      ticket, so the scheme is self-sustaining.
+ * 3: Like queue.h, head and tail are stored without modulo and the
+ *      capacity must be a power of 2, so wrap-around of the tickets over
+ *      SIZE_MAX is handled by the implicit (mod SIZE_MAX+1) for free.
+ * 4: The sequence stores need release semantics and the sequence waits
+ *      need acquire semantics: they are what publishes the element data
+ *      between threads. The fetch-adds on head/tail can be relaxed, since
+ *      they only hand out tickets and carry no data dependency.
+ * 5: The price of the ticket scheme is that a claim is unconditional:
+ *      once fetch-add has run, the caller is committed to that slot and
+ *      mpmc_queue_push blocks (spins) while the queue is full, as
+ *      mpmc_queue_pop does while it is empty. There is no try-variant,
+ *      because backing out of a ticket would reintroduce the CAS loop
+ *      this design exists to avoid. Size the ring for the burst.
+ * 6: Between the claim returning and the commit, the slot is exclusively
+ *      owned by the claiming thread, so the commit can read seq[i] with a
+ *      plain load and only the store must be release.
+ */
+
+#include <stddef.h>
+
+typedef struct { size_t head, tail; } MpmcQueue;
+
+/* Initializes the per-slot sequence array [seq] of a queue of size
+ * 2^[cap_lg2]. Must run before any push/pop, and seq must have exactly
+ * 2^[cap_lg2] entries. */
+static void mpmc_queue_init(size_t *seq, unsigned char cap_lg2)
+{
+    for (size_t i = 0; i < (size_t)1 << cap_lg2; i++)
+        seq[i] = i;
+}
+
+/* Claims one slot of queue [q] of size 2^[cap_lg2] for a push and returns
+ * its index, spinning while the queue is full. The caller must fill the
+ * slot and then call mpmc_queue_commit_push on the same index. */
+static size_t mpmc_queue_push(MpmcQueue *q, unsigned char cap_lg2, size_t *seq)
+{
+    size_t mask = ((size_t)1 << cap_lg2) - 1;
+    size_t ticket = __atomic_fetch_add(&q->tail, 1, __ATOMIC_RELAXED);
+    size_t idx = ticket & mask;
+    // The slot is reusable once the consumer of the previous lap has
+    // bumped its sequence up to our ticket. The ACQUIRE pairs with the
+    // consumer's release store, so our write cannot begin while its read
+    // of the old element is still in flight.
+    while (__atomic_load_n(&seq[idx], __ATOMIC_ACQUIRE) != ticket)
+        ;
+    return idx;
+}
+
+/* Commits the push into slot [idx] of queue seq array [seq], making the
+ * element visible to consumers. */
+static inline void mpmc_queue_commit_push(size_t *seq, size_t idx)
+{
+    __atomic_store_n(&seq[idx], seq[idx] + 1, __ATOMIC_RELEASE);
+}
+
+/* Claims one slot of queue [q] of size 2^[cap_lg2] for a pop and returns
+ * its index, spinning while the queue is empty. The caller must read the
+ * slot and then call mpmc_queue_commit_pop on the same index. */
+static size_t mpmc_queue_pop(MpmcQueue *q, unsigned char cap_lg2, size_t *seq)
+{
+    size_t mask = ((size_t)1 << cap_lg2) - 1;
+    size_t ticket = __atomic_fetch_add(&q->head, 1, __ATOMIC_RELAXED);
+    size_t idx = ticket & mask;
+    // The ACQUIRE pairs with the producer's release store in
+    // mpmc_queue_commit_push: once the sequence reads ticket + 1, the
+    // element bytes are visible to this thread.
+    while (__atomic_load_n(&seq[idx], __ATOMIC_ACQUIRE) != ticket + 1)
+        ;
+    return idx;
+}
+
+/* Commits the pop from slot [idx] of a queue of size 2^[cap_lg2],
+ * handing the slot back to the producers of the next lap. */
+static inline void mpmc_queue_commit_pop(size_t *seq, unsigned char cap_lg2,
+                                         size_t idx)
+{
+    __atomic_store_n(&seq[idx], seq[idx] + ((size_t)1 << cap_lg2) - 1,
+        __ATOMIC_RELEASE);
+}
+
+#endif
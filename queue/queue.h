@@ -72,11 +72,80 @@
  *      This also provides a key advantage:
  *      the queue can be used with any data type, since the indices refer
  *      to positions within the user-defined array.
+ * 8: queue_push reports only the first contiguous run of pushable slots,
+ *      so a producer that wants to fill past the wrap point must call
+ *      queue_push/queue_commit_push once per wrap, paying one acquire
+ *      load of head each time. queue_reserve/queue_publish avoid this:
+ *      one acquire load hands back both spans of the free region at once,
+ *      in the same two-span format the broadcast Slice uses, so a burst
+ *      can be filled across the wrap with a single atomic round-trip.
+ * 9: The atomics are C11 <stdatomic.h> where available, with the same
+ *      vendor fallback layer test.c uses for GCC and MSVC, so the
+ *      header compiles on toolchains without C11 atomics. Each side's
+ *      own variable is read with RELAXED loads: the owner is the only
+ *      writer of that variable, so only the peer's variable needs the
+ *      ACQUIRE.
  */
 
 #include <stddef.h>
 
-typedef struct { size_t head, tail; } Queue;
+// Atomics
+#if __STDC_VERSION__ >= 201112L && !__STDC_NO_ATOMICS
+#  include <stdatomic.h>
+#  define QUEUE_LOAD(p)      atomic_load_explicit(p, memory_order_acquire)
+#  define QUEUE_RLOAD(p)     atomic_load_explicit(p, memory_order_relaxed)
+#  define QUEUE_STORE(p, v)  atomic_store_explicit(p, v, memory_order_release)
+#elif __GNUC__
+#  define _Atomic
+#  define QUEUE_LOAD(p)      __atomic_load_n(p, __ATOMIC_ACQUIRE)
+#  define QUEUE_RLOAD(p)     __atomic_load_n(p, __ATOMIC_RELAXED)
+#  define QUEUE_STORE(p, v)  __atomic_store_n(p, v, __ATOMIC_RELEASE)
+#elif _MSC_VER
+#  define _Atomic volatile
+#  define QUEUE_LOAD(p)      *(p)      // MSC volatile has atomic semantics
+#  define QUEUE_RLOAD(p)     *(p)      //
+#  define QUEUE_STORE(p, v)  *(p) = v  // "
+#endif
+
+// Opt-in instrumentation: define QUEUE_STATS to count, per thread and
+// per translation unit, the events useful for sizing cap_lg2 from
+// data. The counters are thread-local plain increments, so the hot
+// path pays nothing shared; without the define everything compiles
+// away. Harvest from the owning thread with queue_stats_snapshot.
+#ifdef QUEUE_STATS
+#if __STDC_VERSION__ >= 201112L
+#  define QUEUE_TLS _Thread_local
+#elif __GNUC__
+#  define QUEUE_TLS __thread
+#elif _MSC_VER
+#  define QUEUE_TLS __declspec(thread)
+#endif
+typedef struct
+{
+    size_t empty_polls; // queue_pop found nothing poppable
+    size_t full_stalls; // queue_push found nothing pushable
+    size_t wraps;       // the pushable run reached the ring edge
+} QueueStats;
+static QUEUE_TLS QueueStats queue_stats;
+#define QUEUE_STATS_INC(f) (queue_stats.f += 1)
+/* Copies this thread's counters into [out] and restarts them. */
+static void queue_stats_snapshot(QueueStats *out)
+{
+    *out = queue_stats;
+    queue_stats = (QueueStats){0};
+}
+#else
+#define QUEUE_STATS_INC(f) ((void)0)
+#endif
+
+typedef struct { _Atomic size_t head, tail; } Queue;
+
+typedef struct
+{
+    size_t idx[2];
+    size_t cnt[2];
+    size_t len;
+} QueueSlice;
 
 /* Given the queue [q] of size 2^[cap_lg2], sets [*count] to the number
  * of poppable elements and returns the index of the first one. */
@@ -90,7 +159,8 @@ static size_t queue_pop(Queue *q, unsigned char cap_lg2, size_t *count)
     // If that happens, a read might occur before the producer’s writes
     // to the same elements become visible in memory, causing the consumer
     // to read bytes that have not yet been produced.
-    size_t tail = __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE);
+    size_t tail = QUEUE_LOAD(&q->tail);
+    size_t head = QUEUE_RLOAD(&q->head);
     size_t mask = ((size_t)1 << cap_lg2) - 1;
     // The cond variable is 0 iff tail is in the same (mask + 1)-sized block;
     // otherwise, it is:
@@ -98,34 +168,78 @@ static size_t queue_pop(Queue *q, unsigned char cap_lg2, size_t *count)
     //   -- a large odd negative number, if tail has wrapped around SIZE_MAX.
     // The final bitwise AND reduces these cases to just (0, 1).
     // We then use cond to conditionally subtract from the final value.
-    size_t cond = ((tail >> cap_lg2) - (q->head >> cap_lg2)) & 0x1;
-    *count = tail - q->head - (tail & mask) * cond;
+    size_t cond = ((tail >> cap_lg2) - (head >> cap_lg2)) & 0x1;
+    *count = tail - head - (tail & mask) * cond;
+    if (!*count) QUEUE_STATS_INC(empty_polls);
 
-    return q->head & mask;
+    return head & mask;
 }
 
 /* Commits the pop of [count] elements from queue [q]. */
 static inline void queue_commit_pop(Queue *q, size_t count)
 {
-    __atomic_store_n(&q->head, q->head + count, __ATOMIC_RELEASE);
+    QUEUE_STORE(&q->head, QUEUE_RLOAD(&q->head) + count);
 }
 
 /* Given the queue [q] of size 2^[cap_lg2], sets [*count] to the number
  * of pushable elements and returns the index of the first one. */
 static size_t queue_push(Queue *q, unsigned char cap_lg2, size_t *count)
 {
-    size_t head = __atomic_load_n(&q->head, __ATOMIC_ACQUIRE);
+    size_t head = QUEUE_LOAD(&q->head);
+    size_t tail = QUEUE_RLOAD(&q->tail);
     size_t mask = ((size_t)1 << cap_lg2) - 1;
-    size_t cond = ((q->tail >> cap_lg2) - (head >> cap_lg2)) & 0x1;
-    *count = mask + 1 - (q->tail - head) - (head & mask) * (1 - cond);
+    size_t cond = ((tail >> cap_lg2) - (head >> cap_lg2)) & 0x1;
+    *count = mask + 1 - (tail - head) - (head & mask) * (1 - cond);
+    if (!*count) QUEUE_STATS_INC(full_stalls);
+    if (*count && (tail & mask) + *count == mask + 1) QUEUE_STATS_INC(wraps);
 
-    return q->tail & mask;
+    return tail & mask;
 }
 
 /* Commits the push of [count] elements from queue [q]. */
 static inline void queue_commit_push(Queue *q, size_t count)
 {
-    __atomic_store_n(&q->tail, q->tail + count, __ATOMIC_RELEASE);
+    QUEUE_STORE(&q->tail, QUEUE_RLOAD(&q->tail) + count);
+}
+
+/* Given the queue [q] of size 2^[cap_lg2], returns the whole free region
+ * as up to two {index, count} spans with a single acquire load of head.
+ * The producer fills some prefix of the spans, decrements cnt[0]/cnt[1]
+ * by the amounts filled, and passes the slice to queue_publish. */
+static inline QueueSlice queue_reserve(Queue *q, unsigned char cap_lg2)
+{
+    size_t head = QUEUE_LOAD(&q->head);
+    size_t tail = QUEUE_RLOAD(&q->tail);
+    size_t mask = ((size_t)1 << cap_lg2) - 1;
+    QueueSlice s = { .idx[0] = tail & mask,
+        .cnt[0] = mask + 1 - (tail - head) };
+    if (tail >> cap_lg2 == head >> cap_lg2)
+    {
+        s.cnt[0] -= head & mask;
+        s.cnt[1] = head & mask;
+    }
+    s.len = s.cnt[0] + s.cnt[1];
+
+    return s;
+}
+
+/* Publishes the elements written into the slice [s] of queue [q],
+ * i.e. the prefix of the reserved spans the producer consumed. */
+static inline void queue_publish(Queue *q, QueueSlice *s)
+{
+    size_t count = s->len - (s->cnt[0] + s->cnt[1]);
+    QUEUE_STORE(&q->tail, QUEUE_RLOAD(&q->tail) + count);
+}
+
+/* Relaxed occupancy estimate: how many elements are in queue [q], from
+ * two RELAXED loads. Either side may poll this (e.g. for emptiness or
+ * backpressure) without paying queue_pop's acquire fence, which is not
+ * free on weakly ordered machines. The estimate grants no permission
+ * to touch data: to actually read or write elements, go through
+ * queue_pop/queue_push, whose ACQUIRE makes the memory visible. */
+static inline size_t queue_peek_count(Queue *q)
+{
+    return QUEUE_RLOAD(&q->tail) - QUEUE_RLOAD(&q->head);
 }
 
 #endif
\ No newline at end of file
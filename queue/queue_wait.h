@@ -0,0 +1,218 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef QUEUE_WAIT_H
+#define QUEUE_WAIT_H
+
+/* An opt-in waiting layer over queue.h for low-rate endpoints.
+ * queue.h is purely non-blocking: a consumer polling an idle ring burns
+ * a core. This wrapper adds queue_pop_wait/queue_push_wait that spin for
+ * a bounded number of rounds and then sleep in the kernel (futex on
+ * Linux, WaitOnAddress on Windows, a nanosleep backstop elsewhere),
+ * and wake-aware commit functions. Some notable facts:
+ *
+ * 1: The kernel wait cannot key on head/tail directly: they are size_t
+ *      words, while futex and WaitOnAddress as used here operate on a
+ *      32-bit word. The sleepers word below serves both as the parked
+ *      flags (bit 0: consumer, bit 1: producer) and as the wait word.
+ * 2: The commit fast path is preserved: queue_commit_push_wake is the
+ *      release store of queue_commit_push plus one RELAXED load of the
+ *      sleepers word. Only when a sleeper is registered does it pay an
+ *      RMW and a wake syscall, so hot rings that never park pay one
+ *      predictable non-taken branch.
+ * 3: Keeping the waker this cheap leaves a classic store-load race:
+ *      the committer's relaxed load of sleepers may execute before its
+ *      own tail store becomes visible, while the sleeper's recheck read
+ *      the old tail, so both can miss each other and the wake is lost.
+ *      Instead of closing the race with a full fence per commit (which
+ *      would tax the hot path this layer must not touch), every kernel
+ *      wait carries a bounded timeout (QUEUE_WAIT_BACKSTOP_NS), so a
+ *      lost wake costs bounded latency, not a hang. That trade is the
+ *      right one for the low-rate endpoints this layer is meant for.
+ * 4: The sleeper does the expensive ordering work: it registers with a
+ *      SEQ_CST RMW and rechecks the ring before sleeping, so a commit
+ *      that completed before registration is never slept through. The
+ *      kernel compares the wait word against the registered value and
+ *      refuses to sleep if a waker already cleared the flag.
+ */
+
+#include <stdint.h>
+#include "queue.h"
+
+#ifndef QUEUE_WAIT_SPIN
+#define QUEUE_WAIT_SPIN 1024
+#endif
+
+#ifndef QUEUE_WAIT_BACKSTOP_NS
+#define QUEUE_WAIT_BACKSTOP_NS 1000000
+#endif
+
+#define QUEUE_WAIT_POP  ((uint32_t)1 << 0)
+#define QUEUE_WAIT_PUSH ((uint32_t)1 << 1)
+
+typedef struct
+{
+    Queue q;
+    uint32_t sleepers;
+} WaitQueue;
+
+#if defined(__linux__)
+
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <limits.h>
+#include <time.h>
+
+static void queue_wait_kernel(uint32_t *word, uint32_t expected)
+{
+    struct timespec ts = { 0, QUEUE_WAIT_BACKSTOP_NS };
+    syscall(SYS_futex, word, FUTEX_WAIT_PRIVATE, expected, &ts, 0, 0);
+}
+
+static void queue_wake_kernel(uint32_t *word)
+{
+    syscall(SYS_futex, word, FUTEX_WAKE_PRIVATE, INT_MAX, 0, 0, 0);
+}
+
+#elif defined(_WIN32)
+
+// Requires linking against Synchronization.lib (WaitOnAddress family).
+#include <windows.h>
+
+static void queue_wait_kernel(uint32_t *word, uint32_t expected)
+{
+    WaitOnAddress(word, &expected, sizeof(*word),
+        QUEUE_WAIT_BACKSTOP_NS / 1000000);
+}
+
+static void queue_wake_kernel(uint32_t *word)
+{
+    WakeByAddressAll(word);
+}
+
+#else
+
+#include <time.h>
+
+static void queue_wait_kernel(uint32_t *word, uint32_t expected)
+{
+    (void)word; (void)expected;
+    struct timespec ts = { 0, QUEUE_WAIT_BACKSTOP_NS };
+    nanosleep(&ts, 0);
+}
+
+static void queue_wake_kernel(uint32_t *word) { (void)word; }
+
+#endif
+
+/* Like queue_pop, but never returns with [*count] == 0: spins for
+ * QUEUE_WAIT_SPIN rounds, then parks in the kernel until elements
+ * arrive. */
+static size_t queue_pop_wait(WaitQueue *wq, unsigned char cap_lg2,
+                             size_t *count)
+{
+    for (;;)
+    {
+        for (int i = 0; i < QUEUE_WAIT_SPIN; i++)
+        {
+            size_t idx = queue_pop(&wq->q, cap_lg2, count);
+            if (*count) return idx;
+        }
+        uint32_t seen = QUEUE_WAIT_POP |
+            __atomic_fetch_or(&wq->sleepers, QUEUE_WAIT_POP,
+                __ATOMIC_SEQ_CST);
+        // Recheck after registering: a push that committed before the
+        // RMW above is observed here and we never sleep through it.
+        size_t idx = queue_pop(&wq->q, cap_lg2, count);
+        if (*count)
+        {
+            __atomic_fetch_and(&wq->sleepers, ~QUEUE_WAIT_POP,
+                __ATOMIC_RELAXED);
+            return idx;
+        }
+        queue_wait_kernel(&wq->sleepers, seen);
+        __atomic_fetch_and(&wq->sleepers, ~QUEUE_WAIT_POP,
+            __ATOMIC_RELAXED);
+    }
+}
+
+/* Like queue_push, but never returns with [*count] == 0: spins for
+ * QUEUE_WAIT_SPIN rounds, then parks in the kernel until space frees
+ * up. */
+static size_t queue_push_wait(WaitQueue *wq, unsigned char cap_lg2,
+                              size_t *count)
+{
+    for (;;)
+    {
+        for (int i = 0; i < QUEUE_WAIT_SPIN; i++)
+        {
+            size_t idx = queue_push(&wq->q, cap_lg2, count);
+            if (*count) return idx;
+        }
+        uint32_t seen = QUEUE_WAIT_PUSH |
+            __atomic_fetch_or(&wq->sleepers, QUEUE_WAIT_PUSH,
+                __ATOMIC_SEQ_CST);
+        size_t idx = queue_push(&wq->q, cap_lg2, count);
+        if (*count)
+        {
+            __atomic_fetch_and(&wq->sleepers, ~QUEUE_WAIT_PUSH,
+                __ATOMIC_RELAXED);
+            return idx;
+        }
+        queue_wait_kernel(&wq->sleepers, seen);
+        __atomic_fetch_and(&wq->sleepers, ~QUEUE_WAIT_PUSH,
+            __ATOMIC_RELAXED);
+    }
+}
+
+/* Commits the push of [count] elements and wakes the consumer if one is
+ * parked. Without a sleeper this is queue_commit_push plus one relaxed
+ * load. */
+static inline void queue_commit_push_wake(WaitQueue *wq, size_t count)
+{
+    queue_commit_push(&wq->q, count);
+    if (__atomic_load_n(&wq->sleepers, __ATOMIC_RELAXED) & QUEUE_WAIT_POP)
+    {
+        __atomic_fetch_and(&wq->sleepers, ~QUEUE_WAIT_POP,
+            __ATOMIC_SEQ_CST);
+        queue_wake_kernel(&wq->sleepers);
+    }
+}
+
+/* Commits the pop of [count] elements and wakes the producer if one is
+ * parked. Without a sleeper this is queue_commit_pop plus one relaxed
+ * load. */
+static inline void queue_commit_pop_wake(WaitQueue *wq, size_t count)
+{
+    queue_commit_pop(&wq->q, count);
+    if (__atomic_load_n(&wq->sleepers, __ATOMIC_RELAXED) & QUEUE_WAIT_PUSH)
+    {
+        __atomic_fetch_and(&wq->sleepers, ~QUEUE_WAIT_PUSH,
+            __ATOMIC_SEQ_CST);
+        queue_wake_kernel(&wq->sleepers);
+    }
+}
+
+#endif
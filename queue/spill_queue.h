@@ -0,0 +1,227 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SPILL_QUEUE_H
+#define SPILL_QUEUE_H
+
+/* A two-tier SPSC queue: the queue.h ring in front, an append-only
+ * memory-mapped spill file behind it. When the consumer pauses and the
+ * ring fills, pushes divert to the file instead of dropping; when the
+ * consumer catches up it drains the file and the pair degrades back to
+ * the plain ring. A hard drop becomes a latency bump. Some notable
+ * facts:
+ *
+ * 1: FIFO order is preserved by two rules. Producer: once the spill is
+ *      nonempty, every push goes to the spill, even if the ring has
+ *      room again — ring elements must stay older than spill elements.
+ *      Consumer: drain the ring first, then the spill; only a push
+ *      that observed an empty spill enters the ring, so whenever both
+ *      tiers are nonempty everything in the ring predates everything
+ *      in the spill.
+ * 2: The spill is SPSC like the ring: byte offsets head and tail,
+ *      monotonically increasing, written by one side each with release
+ *      stores and read by the peer with acquire loads. Same protocol
+ *      as queue.h, without the power-of-2 wrap because a file does not
+ *      wrap.
+ * 3: Each side keeps one SPILL_CHUNK-sized private mmap window and
+ *      remaps only on chunk crossings, so degraded-mode cost is one
+ *      memcpy per element batch plus a couple of syscalls per chunk.
+ *      The consumer hole-punches each chunk it finishes (where
+ *      supported), so disk usage is bounded by the backlog, not by the
+ *      total volume ever spilled.
+ * 4: This tier copies: spilling zero-copy makes no sense, since the
+ *      bytes must leave the producer's buffer anyway. The push/pop
+ *      entry points therefore take element arrays, unlike the
+ *      index-returning ring API underneath.
+ */
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include "queue.h"
+
+#ifndef SPILL_CHUNK_LG2
+#define SPILL_CHUNK_LG2 20
+#endif
+#define SPILL_CHUNK ((size_t)1 << SPILL_CHUNK_LG2)
+
+typedef struct
+{
+    Queue q;
+    int fd;
+    _Atomic size_t head, tail; // spill byte offsets, head <= tail
+    struct { unsigned char *map; size_t chunk; } w, r;
+} SpillQueue;
+
+/* Wraps queue [sq] around the open, writable, empty file [fd]. */
+static void spill_queue_init(SpillQueue *sq, int fd)
+{
+    sq->q.head = sq->q.tail = 0;
+    sq->fd = fd;
+    sq->head = sq->tail = 0;
+    sq->w.map = sq->r.map = 0;
+    sq->w.chunk = sq->r.chunk = (size_t)-1;
+}
+
+static void spill_queue_destroy(SpillQueue *sq)
+{
+    if (sq->w.map) munmap(sq->w.map, SPILL_CHUNK);
+    if (sq->r.map) munmap(sq->r.map, SPILL_CHUNK);
+}
+
+/* Producer: appends [bytes] of [src] to the spill file. -1 on a file
+ * error, with the spill offsets untouched. */
+static int spill_append(SpillQueue *sq, const unsigned char *src,
+                        size_t bytes)
+{
+    size_t t = QUEUE_RLOAD(&sq->tail);
+    size_t end = t + bytes;
+    while (t < end)
+    {
+        size_t chunk = t >> SPILL_CHUNK_LG2;
+        if (sq->w.chunk != chunk)
+        {
+            if (ftruncate(sq->fd, (off_t)((chunk + 1) << SPILL_CHUNK_LG2)))
+                return -1;
+            void *m = mmap(0, SPILL_CHUNK, PROT_WRITE, MAP_SHARED,
+                sq->fd, (off_t)(chunk << SPILL_CHUNK_LG2));
+            if (m == MAP_FAILED) return -1;
+            if (sq->w.map) munmap(sq->w.map, SPILL_CHUNK);
+            sq->w.map = m;
+            sq->w.chunk = chunk;
+        }
+        size_t off = t & (SPILL_CHUNK - 1);
+        size_t run = SPILL_CHUNK - off < end - t ? SPILL_CHUNK - off
+            : end - t;
+        memcpy(sq->w.map + off, src, run);
+        src += run;
+        t += run;
+    }
+    QUEUE_STORE(&sq->tail, end);
+    return 0;
+}
+
+/* Consumer: copies up to [max] spilled bytes into [dst], hole-punching
+ * chunks it leaves behind. Returns the number of bytes read, rounded
+ * down to whole elements of [esize] bytes — a remap failure can stop
+ * the drain at a chunk boundary mid-element, and advancing head past a
+ * fractional element would misframe the whole stream behind it.
+ * Returns (size_t)-1 when a remap failed before a whole element was
+ * read. */
+static size_t spill_read(SpillQueue *sq, unsigned char *dst, size_t max,
+                         size_t esize)
+{
+    int err = 0;
+    size_t h = QUEUE_RLOAD(&sq->head);
+    size_t avail = QUEUE_LOAD(&sq->tail) - h;
+    size_t n = avail < max ? avail : max;
+    size_t end = h + n;
+    while (h < end)
+    {
+        size_t chunk = h >> SPILL_CHUNK_LG2;
+        if (sq->r.chunk != chunk)
+        {
+            void *m = mmap(0, SPILL_CHUNK, PROT_READ, MAP_SHARED,
+                sq->fd, (off_t)(chunk << SPILL_CHUNK_LG2));
+            if (m == MAP_FAILED) { err = 1; break; }
+            if (sq->r.map)
+            {
+                munmap(sq->r.map, SPILL_CHUNK);
+#ifdef FALLOC_FL_PUNCH_HOLE
+                fallocate(sq->fd,
+                    FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+                    (off_t)(sq->r.chunk << SPILL_CHUNK_LG2), SPILL_CHUNK);
+#endif
+            }
+            sq->r.map = m;
+            sq->r.chunk = chunk;
+        }
+        size_t off = h & (SPILL_CHUNK - 1);
+        size_t run = SPILL_CHUNK - off < end - h ? SPILL_CHUNK - off
+            : end - h;
+        memcpy(dst, sq->r.map + off, run);
+        dst += run;
+        h += run;
+    }
+    // appends are whole elements from offset 0, so element boundaries
+    // sit at multiples of esize; head never leaves one
+    h -= h % esize;
+    size_t done = h - QUEUE_RLOAD(&sq->head);
+    QUEUE_STORE(&sq->head, h);
+    if (!done && err) return (size_t)-1;
+    return done;
+}
+
+/* Producer: pushes [n] elements of [esize] bytes from [src], filling
+ * the ring of 2^[cap_lg2] slots over [buf] and spilling whatever does
+ * not fit (or everything, while the spill is nonempty — see fact 1).
+ * Returns 0, or -1 if the spill file failed; on -1 the elements the
+ * ring accepted are pushed and the rest are not. */
+static int spill_queue_push(SpillQueue *sq, unsigned char cap_lg2,
+                            size_t esize, unsigned char *buf,
+                            const unsigned char *src, size_t n)
+{
+    if (QUEUE_LOAD(&sq->head) == QUEUE_RLOAD(&sq->tail))
+    {
+        QueueSlice s = queue_reserve(&sq->q, cap_lg2);
+        size_t fit = s.len < n ? s.len : n;
+        for (int i = 0; i < 2 && fit; i++)
+        {
+            size_t run = s.cnt[i] < fit ? s.cnt[i] : fit;
+            memcpy(buf + s.idx[i] * esize, src, run * esize);
+            s.cnt[i] -= run;
+            src += run * esize;
+            fit -= run;
+            n -= run;
+        }
+        queue_publish(&sq->q, &s);
+    }
+    if (!n) return 0;
+    return spill_append(sq, src, n * esize);
+}
+
+/* Consumer: copies up to [max] elements into [dst], ring first, then
+ * spill (see fact 1). Returns the number of elements delivered, or
+ * (size_t)-1 if the spill window failed to map with nothing delivered;
+ * keep calling until it returns 0 to know both tiers are empty. */
+static size_t spill_queue_pop(SpillQueue *sq, unsigned char cap_lg2,
+                              size_t esize, unsigned char *buf,
+                              unsigned char *dst, size_t max)
+{
+    size_t cnt;
+    size_t idx = queue_pop(&sq->q, cap_lg2, &cnt);
+    if (cnt)
+    {
+        if (cnt > max) cnt = max;
+        memcpy(dst, buf + idx * esize, cnt * esize);
+        queue_commit_pop(&sq->q, cnt);
+        return cnt;
+    }
+    size_t got = spill_read(sq, dst, max * esize, esize);
+    if (got == (size_t)-1) return (size_t)-1;
+    return got / esize;
+}
+
+#endif
@@ -0,0 +1,162 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef SPRAY_QUEUE_H
+#define SPRAY_QUEUE_H
+
+/* A partitioning distributor: one producer spraying into N queue.h
+ * rings, one consumer per ring, with work stealing to ride out skewed
+ * element cost. The dual of broadcast — each element goes to exactly
+ * one consumer. Some notable facts:
+ *
+ * 1: The producer targets the least-loaded ring, chosen by scanning
+ *      the occupancies queue_peek_count already derives from head and
+ *      tail — no extra shared state for load tracking. The scan is N
+ *      relaxed loads per batch, which is why the API is batched:
+ *      spray a span, not an element.
+ * 2: Stealing breaks the consumer side of SPSC, so each ring's
+ *      consumer side is guarded by a one-byte spinlock; the producer
+ *      side stays lock-free single-producer. The lock is held from
+ *      spray_pop to spray_commit_pop, since the popped span must not
+ *      be re-popped by a thief before the head advances — keep the
+ *      processing between them short, or copy out and commit early.
+ *      A consumer's own ring is usually uncontended, so the common
+ *      case is one uncontested test-and-set per batch.
+ * 3: A thief takes at most half of a victim's poppable elements, from
+ *      the head: the ring pops only at the head, so "steal the tail
+ *      half" becomes "leave the newer half with the owner", which
+ *      preserves FIFO for what the victim keeps and bounds how much a
+ *      thief walks away with.
+ * 4: Per-element FIFO across the whole distributor is gone by design:
+ *      order holds within a ring only. Partition-keyed work should pin
+ *      its key to a ring instead of spraying.
+ */
+
+#include <stdint.h>
+#include "queue.h"
+
+#define SPRAY_MAX_RINGS 32
+#define SPRAY_CACHELINE 64
+
+typedef struct
+{
+    struct __attribute__((aligned(SPRAY_CACHELINE)))
+    {
+        Queue q;
+        unsigned char lock;
+    } ring[SPRAY_MAX_RINGS];
+} Spray;
+
+static inline void spray_lock(Spray *sp, unsigned r)
+{
+    while (__atomic_test_and_set(&sp->ring[r].lock, __ATOMIC_ACQUIRE))
+        ;
+}
+
+static inline int spray_trylock(Spray *sp, unsigned r)
+{
+    return !__atomic_test_and_set(&sp->ring[r].lock, __ATOMIC_ACQUIRE);
+}
+
+static inline void spray_unlock(Spray *sp, unsigned r)
+{
+    __atomic_clear(&sp->ring[r].lock, __ATOMIC_RELEASE);
+}
+
+/* Producer: picks the least-loaded ring with free space, sets [*r] and
+ * [*count] to the pushable run, and returns the index of the first
+ * slot in that ring's buffer. [*count] is 0 if every ring is full. */
+static size_t spray_push(Spray *sp, unsigned nrings, unsigned char cap_lg2,
+                         unsigned *r, size_t *count)
+{
+    size_t cap = (size_t)1 << cap_lg2;
+    unsigned best = 0;
+    size_t best_occ = cap;
+    for (unsigned i = 0; i < nrings; i++)
+    {
+        size_t occ = queue_peek_count(&sp->ring[i].q);
+        if (occ < best_occ)
+        {
+            best = i;
+            best_occ = occ;
+        }
+    }
+    if (best_occ == cap)
+    {
+        *count = 0;
+        return 0;
+    }
+    *r = best;
+    return queue_push(&sp->ring[best].q, cap_lg2, count);
+}
+
+/* Commits the push of [count] elements into ring [r]. */
+static inline void spray_commit_push(Spray *sp, unsigned r, size_t count)
+{
+    queue_commit_push(&sp->ring[r].q, count);
+}
+
+/* Consumer [me]: pops a batch from its own ring, or steals up to half
+ * of a sibling's backlog when its own is empty. Sets [*r] to the ring
+ * served and returns the index of the first element in that ring's
+ * buffer; [*count] is 0 if there is no work anywhere. On success the
+ * ring's consumer lock is held until spray_commit_pop. */
+static size_t spray_pop(Spray *sp, unsigned nrings, unsigned me,
+                        unsigned char cap_lg2, unsigned *r, size_t *count)
+{
+    spray_lock(sp, me);
+    size_t idx = queue_pop(&sp->ring[me].q, cap_lg2, count);
+    if (*count)
+    {
+        *r = me;
+        return idx;
+    }
+    spray_unlock(sp, me);
+    for (unsigned i = 1; i < nrings; i++)
+    {
+        unsigned v = (me + i) % nrings;
+        if (!queue_peek_count(&sp->ring[v].q)) continue;
+        if (!spray_trylock(sp, v)) continue;
+        idx = queue_pop(&sp->ring[v].q, cap_lg2, count);
+        if (*count)
+        {
+            *count = (*count + 1) / 2; // leave the newer half behind
+            *r = v;
+            return idx;
+        }
+        spray_unlock(sp, v);
+    }
+    *count = 0;
+    return 0;
+}
+
+/* Commits the pop of [count] elements from ring [r] and releases its
+ * consumer lock. */
+static inline void spray_commit_pop(Spray *sp, unsigned r, size_t count)
+{
+    queue_commit_pop(&sp->ring[r].q, count);
+    spray_unlock(sp, r);
+}
+
+#endif
@@ -0,0 +1,261 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/* A parameterized stress rig for the rings, generalized from
+ * broadcast/test.c. Where test.c validates one scenario (file fanout,
+ * random batches) after the fact by diffing files, this rig runs named
+ * scenarios with sequence-number payloads verified on the fly, so a
+ * violation aborts at the exact element. Scenarios:
+ *
+ *   spsc_wrap   queue.h producer/consumer with head and tail starting
+ *               just below SIZE_MAX, so the run crosses the integer
+ *               wrap its point-4 comment argues is safe. Alternates
+ *               the push/commit and reserve/publish paths.
+ *   churn       broadcast.h writer under readers that attach, verify
+ *               a while, and detach, with a small ring so the churn
+ *               lands on half-block wrap boundaries — the detach
+ *               bookkeeping (ncycled) is the part test.c never moves.
+ *
+ * Both take an iteration count, and -y PPM injects sched_yield with
+ * the given per-million probability at every verification step to
+ * force preemption points; run the same binary under TSan (see the
+ * Makefile) for data-race coverage of the interleavings this shakes
+ * out. Payloads are the element's absolute sequence number, so any
+ * reorder, skip, duplicate or torn read is caught as it happens. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include "../queue/queue.h"
+#include "../broadcast/broadcast.h"
+
+#define QEXP 6 // small on purpose: more wraps per iteration
+
+static unsigned long yield_ppm = 0;
+
+static void yield_maybe(unsigned *seed)
+{
+    if (yield_ppm && (unsigned long)(rand_r(seed) % 1000000) < yield_ppm)
+        sched_yield();
+}
+
+static void die(const char *what, unsigned long long at)
+{
+    fprintf(stderr, "FAIL %s at seq %llu\n", what, at);
+    exit(1);
+}
+
+// ------------------------------------------------------------ spsc_wrap
+
+static Queue sq;
+static uint64_t sbuf[1 << QEXP];
+static long spsc_iters;
+
+static void *spsc_consumer(void *arg)
+{
+    unsigned seed = 42;
+    uint64_t expect = 0;
+    (void)arg;
+    while (expect < (uint64_t)spsc_iters)
+    {
+        size_t cnt;
+        size_t idx = queue_pop(&sq, QEXP, &cnt);
+        if (!cnt)
+        {
+            sched_yield();
+            continue;
+        }
+        for (size_t k = 0; k < cnt; k++)
+            if (sbuf[idx + k] != expect++)
+                die("spsc order", expect - 1);
+        yield_maybe(&seed);
+        queue_commit_pop(&sq, cnt);
+    }
+    return 0;
+}
+
+static int run_spsc_wrap(void)
+{
+    // start just below the integer wrap (queue.h point 4)
+    sq.head = sq.tail = SIZE_MAX - 999;
+    pthread_t t;
+    pthread_create(&t, 0, spsc_consumer, 0);
+    unsigned seed = 7;
+    uint64_t next = 0;
+    while (next < (uint64_t)spsc_iters)
+    {
+        if (rand_r(&seed) & 1)
+        {
+            size_t cnt;
+            size_t idx = queue_push(&sq, QEXP, &cnt);
+            if (!cnt) { sched_yield(); continue; }
+            size_t n = 1 + rand_r(&seed) % cnt;
+            for (size_t k = 0; k < n; k++) sbuf[idx + k] = next++;
+            yield_maybe(&seed);
+            queue_commit_push(&sq, n);
+        }
+        else
+        {
+            QueueSlice s = queue_reserve(&sq, QEXP);
+            if (!s.len) { sched_yield(); continue; }
+            size_t n = 1 + rand_r(&seed) % s.len;
+            size_t left = n;
+            for (int i = 0; i < 2 && left; i++)
+                while (s.cnt[i] && left)
+                {
+                    sbuf[s.idx[i]++] = next++;
+                    s.cnt[i]--;
+                    left--;
+                }
+            yield_maybe(&seed);
+            queue_publish(&sq, &s);
+        }
+    }
+    pthread_join(t, 0);
+    printf("spsc_wrap: OK, %ld elements across the SIZE_MAX wrap\n",
+        spsc_iters);
+    return 0;
+}
+
+// ---------------------------------------------------------------- churn
+
+static Broadcast bq;
+static uint64_t bbuf[1 << QEXP];
+static _Atomic uint64_t churn_done; // total elements verified, all readers
+static _Atomic int churn_stop;
+static long churn_iters;
+
+static void *churner(void *arg)
+{
+    unsigned seed = (unsigned)(size_t)arg * 2654435761u + 1;
+    while (!churn_stop)
+    {
+        Reader r;
+        if (brdct_attach_reader(&bq, QEXP, &r))
+        {
+            sched_yield();
+            continue;
+        }
+        uint64_t prev = 0;
+        int have_prev = 0;
+        // verify for a random number of slices, then leave: short
+        // lifetimes put attach/detach right on wrap boundaries
+        int rounds = 1 + rand_r(&seed) % 64;
+        for (int j = 0; j < rounds && !churn_stop; j++)
+        {
+            Slice s = brdct_reader_slice(&bq, QEXP, &r);
+            yield_maybe(&seed);
+            uint64_t got = 0;
+            for (int i = 0; i < 2; i++)
+                for (size_t k = 0; k < s.cnt[i]; k++)
+                {
+                    uint64_t v = bbuf[s.idx[i] + k];
+                    if (have_prev && v != prev + 1)
+                        die("churn continuity", v);
+                    prev = v;
+                    have_prev = 1;
+                    got++;
+                }
+            s.cnt[0] = s.cnt[1] = 0;
+            brdct_reader_commit(&bq, QEXP, &r, &s);
+            if (got) churn_done += got;
+            else sched_yield();
+        }
+        yield_maybe(&seed);
+        brdct_detach_reader(&bq, QEXP, &r);
+    }
+    return 0;
+}
+
+static int run_churn(int nreaders)
+{
+    atomic_store(&bq.raw, 0);
+    pthread_t t[64];
+    if (nreaders > 64) nreaders = 64;
+    for (int i = 0; i < nreaders; i++)
+        pthread_create(&t[i], 0, churner, (void *)(size_t)(i + 1));
+    unsigned seed = 3;
+    uint64_t next = 1;
+    while ((long)churn_done < churn_iters)
+    {
+        Slice s = brdct_writer_slice(&bq, QEXP);
+        if (!s.len)
+        {
+            sched_yield();
+            continue;
+        }
+        size_t n = 1 + rand_r(&seed) % s.len;
+        size_t left = n;
+        for (int i = 0; i < 2 && left; i++)
+            while (s.cnt[i] && left)
+            {
+                bbuf[s.idx[i]++] = next++;
+                s.cnt[i]--;
+                left--;
+            }
+        yield_maybe(&seed);
+        brdct_writer_commit(&bq, QEXP, &s);
+    }
+    churn_stop = 1;
+    for (int i = 0; i < nreaders; i++) pthread_join(t[i], 0);
+    printf("churn: OK, %llu elements verified across %llu published\n",
+        (unsigned long long)churn_done, (unsigned long long)(next - 1));
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    const char *scenario = 0;
+    long iters = 200000;
+    int nreaders = 4;
+    for (int i = 1; i < argc; i++)
+    {
+        if (!strcmp(argv[i], "-y") && i + 1 < argc)
+            yield_ppm = strtoul(argv[++i], 0, 10);
+        else if (!strcmp(argv[i], "-r") && i + 1 < argc)
+            nreaders = atoi(argv[++i]);
+        else if (!scenario) scenario = argv[i];
+        else iters = atol(argv[i]);
+    }
+    if (!scenario)
+    {
+        fprintf(stderr,
+            "usage: stress <spsc_wrap|churn> [iters] [-y ppm] [-r readers]\n");
+        return -1;
+    }
+    if (!strcmp(scenario, "spsc_wrap"))
+    {
+        spsc_iters = iters;
+        return run_spsc_wrap();
+    }
+    if (!strcmp(scenario, "churn"))
+    {
+        churn_iters = iters;
+        return run_churn(nreaders);
+    }
+    fprintf(stderr, "unknown scenario %s\n", scenario);
+    return -1;
+}
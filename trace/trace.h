@@ -0,0 +1,212 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2025 Raffaele del Gaudio, https://delgaudio.me
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+/* An event tracer built on the library's own queue: instrumented code
+ * pushes fixed 32-byte records (timestamp, event id, two args) into a
+ * per-thread queue.h ring via the TRACE macro, and a collector thread
+ * drains every ring into a binary file that trace2chrome.py turns into
+ * Chrome's about:tracing format. The push is queue.h's branchless SPSC
+ * push plus one 32-byte store — cheap enough to trace the hot path
+ * itself. Some notable facts:
+ *
+ * 1: One ring per thread, claimed lazily on the thread's first TRACE,
+ *      so instrumented threads never share a producer side and the
+ *      record needs no atomics. The registry and the thread-local
+ *      ring pointer are weak symbols, so every translation unit that
+ *      includes this header shares one registry per process.
+ * 2: A full ring drops the record and bumps the ring's dropped
+ *      counter (producer-private, reported by the collector) rather
+ *      than ever blocking the traced thread. Size TRACE_RING_LG2
+ *      against the collector period.
+ * 3: Timestamps are raw TSC on x86 (one rdtsc, no serialization — a
+ *      tracer wants cheap over exact) and CLOCK_MONOTONIC nanoseconds
+ *      elsewhere. The binary header records a caller-supplied
+ *      ticks-per-microsecond so the converter can scale; pass 0 for
+ *      nanosecond timestamps.
+ * 4: Event ids with TRACE_END_BIT set are span ends: TRACE_BEGIN(id)
+ *      and TRACE_END(id) bracket a duration the converter renders as
+ *      a slice; plain TRACE records become instant events with their
+ *      args attached.
+ * 5: The binary format is the 16-byte header (magic, version,
+ *      ticks-per-us) followed by raw native-endian TraceEvent
+ *      records; the collector appends in drain order, so records are
+ *      in order per thread and roughly ordered globally — the
+ *      converter sorts by timestamp.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include "../queue/queue.h"
+
+#ifndef TRACE_RING_LG2
+#define TRACE_RING_LG2 10
+#endif
+
+#ifndef TRACE_MAX_THREADS
+#define TRACE_MAX_THREADS 64
+#endif
+
+#define TRACE_MAGIC   0x30435254u // "TRC0"
+#define TRACE_END_BIT 0x80000000u
+
+#if defined(_MSC_VER)
+#define TRACE_WEAK __declspec(selectany)
+#define TRACE_TLS  __declspec(thread)
+#else
+#define TRACE_WEAK __attribute__((weak))
+#define TRACE_TLS  __thread
+#endif
+
+// The slot-claim CAS on the same three toolchain branches queue.h's
+// QUEUE_LOAD/QUEUE_STORE layer supports, so the header compiles
+// wherever the queue it builds on does.
+#if __STDC_VERSION__ >= 201112L && !__STDC_NO_ATOMICS
+#define TRACE_CAS(p, e, d) atomic_compare_exchange_strong_explicit( \
+    p, e, d, memory_order_acq_rel, memory_order_relaxed)
+#elif __GNUC__
+#define TRACE_CAS(p, e, d) __atomic_compare_exchange_n( \
+    p, e, d, 0, __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)
+#elif _MSC_VER
+#define TRACE_CAS(p, e, d) \
+    (_InterlockedCompareExchange((volatile long *)(p), d, *(e)) == *(e))
+#endif
+
+typedef struct
+{
+    uint64_t ts;
+    uint32_t id;
+    uint32_t tid;
+    uint64_t a0, a1;
+} TraceEvent;
+
+typedef struct
+{
+    Queue q;
+    uint32_t tid;
+    _Atomic uint32_t used;
+    uint64_t dropped; // producer-private full-ring drops
+    TraceEvent slots[(size_t)1 << TRACE_RING_LG2];
+} TraceRing;
+
+// One registry per process: weak, so every TU sees the same instance.
+TRACE_WEAK TraceRing trace_rings[TRACE_MAX_THREADS];
+TRACE_WEAK TRACE_TLS TraceRing *trace_tls;
+
+static inline uint64_t trace_now(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* Claims this thread's ring on its first event. NULL (and no events
+ * recorded) once TRACE_MAX_THREADS threads have claimed. */
+static TraceRing *trace_ring_acquire(void)
+{
+    for (uint32_t i = 0; i < TRACE_MAX_THREADS; i++)
+    {
+        uint32_t expect = 0;
+        if (!TRACE_CAS(&trace_rings[i].used, &expect, 1))
+            continue;
+        trace_rings[i].tid = i;
+        trace_tls = &trace_rings[i];
+        return trace_tls;
+    }
+    return 0;
+}
+
+#define TRACE(id, a0, a1) \
+    do \
+    { \
+        TraceRing *tr_ = trace_tls ? trace_tls : trace_ring_acquire(); \
+        if (!tr_) break; \
+        size_t cnt_; \
+        size_t idx_ = queue_push(&tr_->q, TRACE_RING_LG2, &cnt_); \
+        if (!cnt_) { tr_->dropped += 1; break; } \
+        tr_->slots[idx_] = (TraceEvent){ trace_now(), (uint32_t)(id), \
+            tr_->tid, (uint64_t)(a0), (uint64_t)(a1) }; \
+        queue_commit_push(&tr_->q, 1); \
+    } while (0)
+
+#define TRACE_BEGIN(id) TRACE((id), 0, 0)
+#define TRACE_END(id)   TRACE((uint32_t)(id) | TRACE_END_BIT, 0, 0)
+
+/* Writes the binary header. [ticks_per_us] scales the timestamps for
+ * the converter: the calibrated TSC rate on x86, 0 when trace_now
+ * already returns nanoseconds. */
+static int trace_write_header(FILE *out, uint64_t ticks_per_us)
+{
+    uint32_t hdr[2] = { TRACE_MAGIC, 1 };
+    if (fwrite(hdr, sizeof(hdr), 1, out) != 1) return -1;
+    if (fwrite(&ticks_per_us, sizeof(ticks_per_us), 1, out) != 1)
+        return -1;
+    return 0;
+}
+
+/* Collector: drains every claimed ring into [out]. Call it
+ * periodically from one thread; returns the number of records
+ * written, so a zero return after the traced threads quiesce means
+ * the trace is complete. */
+static size_t trace_collect(FILE *out)
+{
+    size_t total = 0;
+    for (uint32_t i = 0; i < TRACE_MAX_THREADS; i++)
+    {
+        TraceRing *tr = &trace_rings[i];
+        if (!QUEUE_LOAD(&tr->used))
+            continue;
+        for (;;)
+        {
+            size_t cnt;
+            size_t idx = queue_pop(&tr->q, TRACE_RING_LG2, &cnt);
+            if (!cnt) break;
+            total += fwrite(tr->slots + idx, sizeof(TraceEvent), cnt, out);
+            queue_commit_pop(&tr->q, cnt);
+        }
+    }
+    return total;
+}
+
+/* Sum of records dropped on full rings so far (approximate while
+ * traced threads are running). */
+static uint64_t trace_dropped(void)
+{
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < TRACE_MAX_THREADS; i++)
+        if (QUEUE_LOAD(&trace_rings[i].used))
+            total += trace_rings[i].dropped;
+    return total;
+}
+
+#endif
@@ -0,0 +1,67 @@
+#!/usr/bin/env python3
+# Converts a trace.h binary capture into Chrome's about:tracing /
+# Perfetto JSON. Usage: ./trace2chrome.py capture.bin > capture.json
+#
+# Records are the native-endian 32-byte TraceEvent structs after the
+# 16-byte header (magic, version, ticks-per-us). Ids with the top bit
+# set close the span opened by the same id without it (TRACE_BEGIN /
+# TRACE_END); everything else becomes an instant event with a0/a1 as
+# args.
+
+import json
+import struct
+import sys
+
+MAGIC = 0x30435254
+END_BIT = 0x80000000
+
+HEADER = struct.Struct("=IIQ")
+RECORD = struct.Struct("=QIIQQ")
+
+
+def main():
+    if len(sys.argv) != 2:
+        sys.exit("usage: trace2chrome.py capture.bin")
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+    magic, version, ticks_per_us = HEADER.unpack_from(data, 0)
+    if magic != MAGIC:
+        sys.exit("not a trace.h capture")
+    if version != 1:
+        sys.exit("unsupported capture version %d" % version)
+    scale = ticks_per_us if ticks_per_us else 1000.0  # 0 -> nanoseconds
+
+    events = []
+    for off in range(HEADER.size, len(data), RECORD.size):
+        ts, eid, tid, a0, a1 = RECORD.unpack_from(data, off)
+        ev = {
+            "name": "evt_%d" % (eid & ~END_BIT),
+            "ph": "E" if eid & END_BIT else "i",
+            "ts": ts / scale,
+            "pid": 0,
+            "tid": tid,
+        }
+        if not eid & END_BIT:
+            ev["args"] = {"a0": a0, "a1": a1}
+            ev["s"] = "t"
+        events.append(ev)
+
+    events.sort(key=lambda e: e["ts"])
+    # pair begins with their ends: a begin is any instant whose id has a
+    # matching end later on the same thread
+    open_spans = {}
+    for ev in events:
+        key = (ev["tid"], ev["name"])
+        if ev["ph"] == "E":
+            if key in open_spans and open_spans[key]:
+                b = open_spans[key].pop()
+                b["ph"] = "B"
+                del b["s"]
+        else:
+            open_spans.setdefault(key, []).append(ev)
+
+    json.dump({"traceEvents": events}, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()